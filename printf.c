@@ -32,32 +32,19 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
+// printf.h includes printf_config.h if PRINTF_INCLUDE_CONFIG_H is defined
 #include "printf.h"
 
 
-// define this globally (e.g. gcc -DPRINTF_INCLUDE_CONFIG_H ...) to include the
-// printf_config.h header file
-// default: undefined
-#ifdef PRINTF_INCLUDE_CONFIG_H
-#include "printf_config.h"
-#endif
-
-
 // 'ntoa' conversion buffer size, this must be big enough to hold one converted
-// numeric number including padded zeros (dynamically created on stack)
+// numeric number, padded zeros are emitted separately (dynamically created on stack)
 // default: 32 byte
 #ifndef PRINTF_NTOA_BUFFER_SIZE
 #define PRINTF_NTOA_BUFFER_SIZE    32U
 #endif
 
-// 'ftoa' conversion buffer size, this must be big enough to hold one converted
-// float number including padded zeros (dynamically created on stack)
-// default: 32 byte
-#ifndef PRINTF_FTOA_BUFFER_SIZE
-#define PRINTF_FTOA_BUFFER_SIZE    32U
-#endif
-
 // support for the floating point type (%f)
 // default: activated
 #ifndef PRINTF_DISABLE_SUPPORT_FLOAT
@@ -76,11 +63,10 @@
 #define PRINTF_DEFAULT_FLOAT_PRECISION  6U
 #endif
 
-// define the largest float suitable to print with %f
-// default: 1e9
-#ifndef PRINTF_MAX_FLOAT
-#define PRINTF_MAX_FLOAT  1e9
-#endif
+// define the largest float to print with %f, larger values switch to exponential
+// notation, which bounds the output length
+// default: undefined, %f prints all whole digits exactly
+// #define PRINTF_MAX_FLOAT  1e9
 
 // support for the long long types (%llu or %p)
 // default: activated
@@ -88,6 +74,35 @@
 #define PRINTF_SUPPORT_LONG_LONG
 #endif
 
+// support for the shortest round-trip floating point notation (%r), converted
+// by table driven integer arithmetic, this needs long long support
+// default: activated
+#if !defined(PRINTF_DISABLE_SUPPORT_SHORTEST) && defined(PRINTF_SUPPORT_FLOAT) && defined(PRINTF_SUPPORT_LONG_LONG)
+#define PRINTF_SUPPORT_SHORTEST
+#endif
+
+// support for word-at-a-time scanning of literal format text
+// this reads whole aligned words and may touch bytes past the terminating 0
+// (never across a page), so it is switched off for the address and memory sanitizer
+// builds of GCC and clang, define PRINTF_DISABLE_SUPPORT_FAST_SCAN for valgrind runs
+// default: activated
+#if defined(__SANITIZE_ADDRESS__)
+#define PRINTF_SANITIZER
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#define PRINTF_SANITIZER
+#endif
+#endif
+#if !defined(PRINTF_DISABLE_SUPPORT_FAST_SCAN) && !defined(PRINTF_SANITIZER)
+#define PRINTF_SUPPORT_FAST_SCAN
+#endif
+
+// support for converting 8 decimal or hex digits at once by SWAR (SIMD within a register)
+// default: activated on little endian GCC/clang targets
+#if !defined(PRINTF_DISABLE_SUPPORT_SWAR_DIGITS) && defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define PRINTF_SUPPORT_SWAR_DIGITS
+#endif
+
 // support for the ptrdiff_t type (%t)
 // ptrdiff_t is normally defined in <stddef.h> as long or long long type
 // default: activated
@@ -95,6 +110,87 @@
 #define PRINTF_SUPPORT_PTRDIFF_T
 #endif
 
+// support for the 128 bit integer type (%w128d), this needs the __int128
+// type of GCC/clang and long long support
+// default: activated if available
+#if !defined(PRINTF_DISABLE_SUPPORT_INT128) && defined(__SIZEOF_INT128__) && defined(PRINTF_SUPPORT_LONG_LONG)
+#define PRINTF_SUPPORT_INT128
+#endif
+
+// support for the lock-free single producer/single consumer ring buffer output
+// (rbprintf), this needs the GCC/clang __atomic builtins
+// default: activated if available
+#if !defined(PRINTF_DISABLE_SUPPORT_RINGBUFFER) && defined(__GNUC__)
+#define PRINTF_SUPPORT_RINGBUFFER
+#endif
+
+// support for the lock-free multi producer/single consumer log buffer output
+// (logprintf), this needs the GCC/clang __atomic builtins
+// default: activated if available
+#if !defined(PRINTF_DISABLE_SUPPORT_LOGBUFFER) && defined(__GNUC__)
+#define PRINTF_SUPPORT_LOGBUFFER
+#endif
+
+// support for deferred formatting into a log buffer (printf_deferred)
+// default: activated if the log buffer is supported
+#if !defined(PRINTF_DISABLE_SUPPORT_DEFERRED) && defined(PRINTF_SUPPORT_LOGBUFFER)
+#define PRINTF_SUPPORT_DEFERRED
+#endif
+
+// support for binary log encoding of format string ids and packed arguments (binprintf)
+// default: activated
+#ifndef PRINTF_DISABLE_SUPPORT_BINARY
+#define PRINTF_SUPPORT_BINARY
+#endif
+
+// size of the printf()/vprintf() staging buffer, a size > 0 enables buffered
+// output through _putblock() instead of one _putchar() call per character
+// (dynamically created on stack)
+// default: 0 (unbuffered)
+#ifndef PRINTF_PUTBLOCK_BUFFER_SIZE
+#define PRINTF_PUTBLOCK_BUFFER_SIZE  0U
+#endif
+#if (PRINTF_PUTBLOCK_BUFFER_SIZE > 0U)
+#define PRINTF_SUPPORT_PUTBLOCK
+#endif
+
+// size of the dprintf()/vdprintf() staging buffer, a size > 0 enables the
+// POSIX file descriptor output, which needs write() from <unistd.h>
+// (dynamically created on stack)
+// default: 0 (disabled)
+#ifndef PRINTF_DPRINTF_BUFFER_SIZE
+#define PRINTF_DPRINTF_BUFFER_SIZE  0U
+#endif
+#if (PRINTF_DPRINTF_BUFFER_SIZE > 0U)
+#define PRINTF_SUPPORT_DPRINTF
+#endif
+
+// size of the asprintf()/vasprintf() stack buffer, a size > 0 enables the
+// allocating output, which needs the _printf_realloc() and _printf_free() hooks
+// (dynamically created on stack)
+// default: 0 (disabled)
+#ifndef PRINTF_ASPRINTF_BUFFER_SIZE
+#define PRINTF_ASPRINTF_BUFFER_SIZE  0U
+#endif
+#if (PRINTF_ASPRINTF_BUFFER_SIZE > 0U)
+#define PRINTF_SUPPORT_ASPRINTF
+#endif
+
+// define this globally (e.g. gcc -DPRINTF_ENABLE_SUPPORT_THREAD_BUFFER ...) to
+// enable per thread line buffers for printf() (printf_thread_buffer), which need
+// _putblock() output and thread local storage
+// default: undefined
+#if defined(PRINTF_ENABLE_SUPPORT_THREAD_BUFFER) && defined(PRINTF_SUPPORT_PUTBLOCK)
+#define PRINTF_SUPPORT_THREAD_BUFFER
+#if defined(__cplusplus) && (__cplusplus >= 201103L)
+#define PRINTF_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define PRINTF_THREAD_LOCAL _Thread_local
+#else
+#define PRINTF_THREAD_LOCAL __thread
+#endif
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // internal flag definitions
@@ -110,6 +206,13 @@
 #define FLAGS_LONG_LONG (1U <<  9U)
 #define FLAGS_PRECISION (1U << 10U)
 #define FLAGS_ADAPT_EXP (1U << 11U)
+#define FLAGS_INT128    (1U << 12U)
+
+
+#if defined(PRINTF_SUPPORT_INT128)
+__extension__ typedef __int128          int128_type;
+__extension__ typedef unsigned __int128 uint128_type;
+#endif
 
 
 // import float.h for DBL_MAX
@@ -117,9 +220,16 @@
 #include <float.h>
 #endif
 
+// import unistd.h for write()
+#if defined(PRINTF_SUPPORT_DPRINTF)
+#include <errno.h>
+#include <unistd.h>
+#endif
+
 
 // output function type
-typedef void (*out_fct_type)(char character, void* buffer, size_t idx, size_t maxlen);
+// outputs 'len' characters of 'data' to position 'idx' of 'buffer'
+typedef void (*out_fct_type)(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen);
 
 
 // wrapper (used as buffer) for output function type
@@ -129,786 +239,3626 @@ typedef struct {
 } out_fct_wrap_type;
 
 
+// wrapper (used as buffer) for chunked output function type
+typedef struct {
+  void  (*fct)(const char* data, size_t len, void* arg);
+  void* arg;
+} out_chunk_wrap_type;
+
+
 // internal buffer output
-static inline void _out_buffer(char character, void* buffer, size_t idx, size_t maxlen)
+static inline void _out_buffer(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
   if (idx < maxlen) {
-    ((char*)buffer)[idx] = character;
+    if (len > maxlen - idx) {
+      len = maxlen - idx;
+    }
+    memcpy((char*)buffer + idx, data, len);
   }
 }
 
 
 // internal null output
-static inline void _out_null(char character, void* buffer, size_t idx, size_t maxlen)
+static inline void _out_null(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
-  (void)character; (void)buffer; (void)idx; (void)maxlen;
+  (void)data; (void)len; (void)buffer; (void)idx; (void)maxlen;
 }
 
 
 // internal _putchar wrapper
-static inline void _out_char(char character, void* buffer, size_t idx, size_t maxlen)
+static inline void _out_char(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
   (void)buffer; (void)idx; (void)maxlen;
-  if (character) {
-    _putchar(character);
+  while (len--) {
+    if (*data) {
+      _putchar(*data);
+    }
+    data++;
   }
 }
 
 
 // internal output function wrapper
-static inline void _out_fct(char character, void* buffer, size_t idx, size_t maxlen)
+static inline void _out_fct(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
   (void)idx; (void)maxlen;
-  if (character) {
-    // buffer is the output fct pointer
-    ((out_fct_wrap_type*)buffer)->fct(character, ((out_fct_wrap_type*)buffer)->arg);
+  while (len--) {
+    if (*data) {
+      // buffer is the output fct pointer
+      ((out_fct_wrap_type*)buffer)->fct(*data, ((out_fct_wrap_type*)buffer)->arg);
+    }
+    data++;
   }
 }
 
 
-// internal secure strlen
-// \return The length of the string (excluding the terminating 0) limited by 'maxsize'
-static inline unsigned int _strnlen_s(const char* str, size_t maxsize)
+// internal chunked output function wrapper
+static inline void _out_chunk(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
-  const char* s;
-  for (s = str; *s && maxsize--; ++s);
-  return (unsigned int)(s - str);
+  (void)idx; (void)maxlen;
+  // a 0 is only ever output on its own (termination or %c), skip it like _out_fct
+  if (len && ((len > 1U) || *data)) {
+    // buffer is the output fct pointer
+    ((out_chunk_wrap_type*)buffer)->fct(data, len, ((out_chunk_wrap_type*)buffer)->arg);
+  }
 }
 
 
-// internal test if char is a digit (0-9)
-// \return true if char is a digit
-static inline bool _is_digit(char ch)
+// segment list (used as buffer) for scatter/gather output
+typedef struct {
+  struct printf_iovec* iov;
+  size_t iovcnt;      // number of used segments
+  size_t iovmax;      // number of available segments
+  char*  scratch;     // copies of converted numbers etc.
+  size_t used;        // used scratch space
+  size_t size;        // available scratch space
+  bool   truncated;   // segments or scratch space ran out, drop the rest
+} out_iov_type;
+
+
+// internal scatter/gather output, appends a reference to 'data' as segment
+static void _out_iov_ref(const char* data, size_t len, out_iov_type* iov)
 {
-  return (ch >= '0') && (ch <= '9');
+  if (!len || iov->truncated) {
+    return;
+  }
+  struct printf_iovec* last = iov->iovcnt ? &iov->iov[iov->iovcnt - 1U] : NULL;
+  if (last && ((const char*)last->iov_base + last->iov_len == data)) {
+    // contiguous with the last segment
+    last->iov_len += len;
+  }
+  else if (iov->iovcnt < iov->iovmax) {
+    iov->iov[iov->iovcnt].iov_base = (void*)(uintptr_t)data;
+    iov->iov[iov->iovcnt].iov_len  = len;
+    iov->iovcnt++;
+  }
+  else {
+    iov->truncated = true;
+  }
 }
 
 
-// internal ASCII string to unsigned int conversion
-static unsigned int _atoi(const char** str)
+// internal scatter/gather output, data is transient and copied to the scratch space
+static void _out_iov(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
-  unsigned int i = 0U;
-  while (_is_digit(**str)) {
-    i = i * 10U + (unsigned int)(*((*str)++) - '0');
+  out_iov_type* iov = (out_iov_type*)buffer;
+  (void)idx; (void)maxlen;
+  // a 0 is only ever output on its own (termination or %c), skip it like _out_fct
+  if (!len || ((len == 1U) && !*data) || iov->truncated) {
+    return;
   }
-  return i;
+  if (len > iov->size - iov->used) {
+    iov->truncated = true;
+    return;
+  }
+  memcpy(iov->scratch + iov->used, data, len);
+  _out_iov_ref(iov->scratch + iov->used, len, iov);
+  iov->used += len;
 }
 
 
-// output the specified string in reverse, taking care of any zero-padding
-static size_t _out_rev(out_fct_type out, char* buffer, size_t idx, size_t maxlen, const char* buf, size_t len, unsigned int width, unsigned int flags)
-{
-  const size_t start_idx = idx;
+#if defined(PRINTF_SUPPORT_DPRINTF)
+// staging buffer (used as buffer) for file descriptor output
+typedef struct {
+  int    fd;
+  bool   error;
+  size_t len;
+  char   data[PRINTF_DPRINTF_BUFFER_SIZE];
+} out_fd_type;
 
-  // pad spaces up to given width
-  if (!(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD)) {
-    for (size_t i = len; i < width; i++) {
-      out(' ', buffer, idx++, maxlen);
-    }
-  }
 
-  // reverse string
+// internal write of a whole block, continues after signals and short writes
+// \return false on error
+static bool _write_fd(int fd, const char* data, size_t len)
+{
   while (len) {
-    out(buf[--len], buffer, idx++, maxlen);
-  }
-
-  // append pad spaces up to given width
-  if (flags & FLAGS_LEFT) {
-    while (idx - start_idx < width) {
-      out(' ', buffer, idx++, maxlen);
+    const ssize_t n = write(fd, data, len);
+    if (n > 0) {
+      data += n;
+      len  -= (size_t)n;
+    }
+    else if ((n == 0) || (errno != EINTR)) {
+      return false;
     }
   }
-
-  return idx;
+  return true;
 }
 
 
-// internal itoa format
-static size_t _ntoa_format(out_fct_type out, char* buffer, size_t idx, size_t maxlen, char* buf, size_t len, bool negative, unsigned int base, unsigned int prec, unsigned int width, unsigned int flags)
+// internal file descriptor output, writes only when the staging buffer is full
+static void _out_fd(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
-  // pad leading zeros
-  if (!(flags & FLAGS_LEFT)) {
-    if (width && (flags & FLAGS_ZEROPAD) && (negative || (flags & (FLAGS_PLUS | FLAGS_SPACE)))) {
-      width--;
-    }
-    while ((len < prec) && (len < PRINTF_NTOA_BUFFER_SIZE)) {
-      buf[len++] = '0';
-    }
-    while ((flags & FLAGS_ZEROPAD) && (len < width) && (len < PRINTF_NTOA_BUFFER_SIZE)) {
-      buf[len++] = '0';
-    }
-  }
+  out_fd_type* out_fd = (out_fd_type*)buffer;
+  (void)idx; (void)maxlen;
 
-  // handle hash
-  if (flags & FLAGS_HASH) {
-    if (!(flags & FLAGS_PRECISION) && len && ((len == prec) || (len == width))) {
-      len--;
-      if (len && (base == 16U)) {
-        len--;
-      }
-    }
-    if ((base == 16U) && !(flags & FLAGS_UPPERCASE) && (len < PRINTF_NTOA_BUFFER_SIZE)) {
-      buf[len++] = 'x';
-    }
-    else if ((base == 16U) && (flags & FLAGS_UPPERCASE) && (len < PRINTF_NTOA_BUFFER_SIZE)) {
-      buf[len++] = 'X';
-    }
-    else if ((base == 2U) && (len < PRINTF_NTOA_BUFFER_SIZE)) {
-      buf[len++] = 'b';
-    }
-    if (len < PRINTF_NTOA_BUFFER_SIZE) {
-      buf[len++] = '0';
-    }
+  // a 0 is only ever output on its own (termination or %c), skip it like _out_fct
+  if (!len || ((len == 1U) && !*data) || out_fd->error) {
+    return;
   }
-
-  if (len < PRINTF_NTOA_BUFFER_SIZE) {
-    if (negative) {
-      buf[len++] = '-';
-    }
-    else if (flags & FLAGS_PLUS) {
-      buf[len++] = '+';  // ignore the space if the '+' exists
+  if (len > sizeof(out_fd->data) - out_fd->len) {
+    // flush the staged output first
+    if (out_fd->len) {
+      out_fd->error = !_write_fd(out_fd->fd, out_fd->data, out_fd->len);
+      out_fd->len   = 0U;
     }
-    else if (flags & FLAGS_SPACE) {
-      buf[len++] = ' ';
+    // pass big runs through without staging
+    if (len >= sizeof(out_fd->data)) {
+      out_fd->error = out_fd->error || !_write_fd(out_fd->fd, data, len);
+      return;
     }
   }
-
-  return _out_rev(out, buffer, idx, maxlen, buf, len, width, flags);
+  memcpy(out_fd->data + out_fd->len, data, len);
+  out_fd->len += len;
 }
+#endif  // PRINTF_SUPPORT_DPRINTF
 
 
-// internal itoa for 'long' type
-static size_t _ntoa_long(out_fct_type out, char* buffer, size_t idx, size_t maxlen, unsigned long value, bool negative, unsigned long base, unsigned int prec, unsigned int width, unsigned int flags)
+#if defined(PRINTF_SUPPORT_RINGBUFFER)
+// ring buffer position (used as buffer) for ring buffer output
+typedef struct {
+  struct printf_ring* ring;
+  size_t head;        // write position, published when the call is complete
+  size_t avail;       // free space
+  bool   overflow;
+} out_ring_type;
+
+
+// internal ring buffer output, wraps across the end of the ring
+static void _out_ring(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
-  char buf[PRINTF_NTOA_BUFFER_SIZE];
-  size_t len = 0U;
+  out_ring_type* out_ring = (out_ring_type*)buffer;
+  (void)idx; (void)maxlen;
 
-  // no hash for 0 values
-  if (!value) {
-    flags &= ~FLAGS_HASH;
+  // a 0 is only ever output on its own (termination or %c), skip it like _out_fct
+  if (!len || ((len == 1U) && !*data) || out_ring->overflow) {
+    return;
   }
-
-  // write if precision != 0 and value is != 0
-  if (!(flags & FLAGS_PRECISION) || value) {
-    do {
-      const char digit = (char)(value % base);
-      buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
-      value /= base;
-    } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+  if (len > out_ring->avail) {
+    out_ring->overflow = true;
+    return;
   }
-
-  return _ntoa_format(out, buffer, idx, maxlen, buf, len, negative, (unsigned int)base, prec, width, flags);
+  const size_t pos   = out_ring->head & (out_ring->ring->size - 1U);
+  const size_t first = (len < out_ring->ring->size - pos) ? len : out_ring->ring->size - pos;
+  memcpy(out_ring->ring->data + pos, data, first);
+  memcpy(out_ring->ring->data, data + first, len - first);
+  out_ring->head  += len;
+  out_ring->avail -= len;
 }
+#endif  // PRINTF_SUPPORT_RINGBUFFER
 
 
-// internal itoa for 'long long' type
-#if defined(PRINTF_SUPPORT_LONG_LONG)
-static size_t _ntoa_long_long(out_fct_type out, char* buffer, size_t idx, size_t maxlen, unsigned long long value, bool negative, unsigned long long base, unsigned int prec, unsigned int width, unsigned int flags)
+#if defined(PRINTF_SUPPORT_ASPRINTF)
+// growing buffer (used as buffer) for allocating output
+typedef struct {
+  char*  data;        // stack buffer first, then allocated memory
+  size_t len;
+  size_t size;
+  bool   error;
+  char   stack[PRINTF_ASPRINTF_BUFFER_SIZE];
+} out_alloc_type;
+
+
+// internal allocating output, spills from the stack buffer to allocated memory
+static void _out_alloc(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
-  char buf[PRINTF_NTOA_BUFFER_SIZE];
-  size_t len = 0U;
+  out_alloc_type* out_alloc = (out_alloc_type*)buffer;
+  (void)idx; (void)maxlen;
 
-  // no hash for 0 values
-  if (!value) {
-    flags &= ~FLAGS_HASH;
+  if (out_alloc->error) {
+    return;
   }
-
-  // write if precision != 0 and value is != 0
-  if (!(flags & FLAGS_PRECISION) || value) {
-    do {
-      const char digit = (char)(value % base);
-      buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
-      value /= base;
-    } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+  if (len > out_alloc->size - out_alloc->len) {
+    // grow at least to the double size
+    size_t size = out_alloc->size * 2U;
+    if (size < out_alloc->len + len) {
+      size = out_alloc->len + len;
+    }
+    const bool spill = (out_alloc->data == out_alloc->stack);
+    char* mem = (char*)_printf_realloc(spill ? NULL : out_alloc->data, size);
+    if (!mem) {
+      out_alloc->error = true;
+      return;
+    }
+    if (spill) {
+      memcpy(mem, out_alloc->stack, out_alloc->len);
+    }
+    out_alloc->data = mem;
+    out_alloc->size = size;
   }
-
-  return _ntoa_format(out, buffer, idx, maxlen, buf, len, negative, (unsigned int)base, prec, width, flags);
+  memcpy(out_alloc->data + out_alloc->len, data, len);
+  out_alloc->len += len;
 }
-#endif  // PRINTF_SUPPORT_LONG_LONG
+#endif  // PRINTF_SUPPORT_ASPRINTF
 
 
-#if defined(PRINTF_SUPPORT_FLOAT)
-
-#if defined(PRINTF_SUPPORT_EXPONENTIAL)
-// forward declaration so that _ftoa can switch to exp notation for values > PRINTF_MAX_FLOAT
-static size_t _etoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags);
-#endif
+// arena position (used as buffer) for arena output
+typedef struct {
+  struct printf_arena* arena;
+  size_t start;       // start of the output in the current block
+  bool   error;
+} out_arena_type;
 
 
-// internal ftoa for fixed decimal floating point
-static size_t _ftoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags)
+// internal arena output, moves the output to a new block if the current one is full
+static void _out_arena(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
 {
-  char buf[PRINTF_FTOA_BUFFER_SIZE];
-  size_t len  = 0U;
-  double diff = 0.0;
-
-  // powers of 10
-  static const double pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
-
-  // test for special values
-  if (value != value)
-    return _out_rev(out, buffer, idx, maxlen, "nan", 3, width, flags);
-  if (value < -DBL_MAX)
-    return _out_rev(out, buffer, idx, maxlen, "fni-", 4, width, flags);
-  if (value > DBL_MAX)
-    return _out_rev(out, buffer, idx, maxlen, (flags & FLAGS_PLUS) ? "fni+" : "fni", (flags & FLAGS_PLUS) ? 4U : 3U, width, flags);
+  out_arena_type*      out_arena = (out_arena_type*)buffer;
+  struct printf_arena* arena     = out_arena->arena;
+  (void)idx; (void)maxlen;
 
-  // test for very large values
-  // standard printf behavior is to print EVERY whole number digit -- which could be 100s of characters overflowing your buffers == bad
-  if ((value > PRINTF_MAX_FLOAT) || (value < -PRINTF_MAX_FLOAT)) {
-#if defined(PRINTF_SUPPORT_EXPONENTIAL)
-    return _etoa(out, buffer, idx, maxlen, value, prec, width, flags);
-#else
-    return 0U;
-#endif
+  if (out_arena->error) {
+    return;
   }
-
-  // test for negative
-  bool negative = false;
-  if (value < 0) {
-    negative = true;
-    value = 0 - value;
+  if (len > arena->size - arena->used) {
+    // allocate a new block, linked to the previous ones through its first word
+    const size_t done = arena->used - out_arena->start;
+    size_t size = sizeof(void*) + 2U * (done + len);
+    if (size < arena->block_size) {
+      size = arena->block_size;
+    }
+    char* block = arena->alloc ? (char*)arena->alloc(size) : NULL;
+    if (!block) {
+      out_arena->error = true;
+      return;
+    }
+    memcpy(block, &arena->blocks, sizeof(void*));
+    arena->blocks = block;
+    // move what is done so far
+    memcpy(block + sizeof(void*), arena->data + out_arena->start, done);
+    arena->data      = block;
+    arena->size      = size;
+    arena->used      = sizeof(void*) + done;
+    out_arena->start = sizeof(void*);
   }
+  memcpy(arena->data + arena->used, data, len);
+  arena->used += len;
+}
 
-  // set default precision, if not set explicitly
-  if (!(flags & FLAGS_PRECISION)) {
-    prec = PRINTF_DEFAULT_FLOAT_PRECISION;
+
+// output a run which stays valid for the whole call (format text, string arguments,
+// constant blocks), the scatter/gather output references it instead of copying
+static inline void _out_ref(out_fct_type out, const char* data, size_t len, char* buffer, size_t idx, size_t maxlen)
+{
+  if (out == _out_iov) {
+    _out_iov_ref(data, len, (out_iov_type*)(void*)buffer);
   }
-  // limit precision to 9, cause a prec >= 10 can lead to overflow errors
-  while ((len < PRINTF_FTOA_BUFFER_SIZE) && (prec > 9U)) {
-    buf[len++] = '0';
-    prec--;
+  else {
+    out(data, len, buffer, idx, maxlen);
   }
+}
+
+
+#if defined(PRINTF_SUPPORT_PUTBLOCK)
+// staging buffer (used as buffer) for _putblock output
+typedef struct {
+  char*  data;
+  size_t size;
+  size_t len;
+  bool   keep;        // keep partial lines across calls (thread buffer)
+} out_block_type;
 
-  int whole = (int)value;
-  double tmp = (value - whole) * pow10[prec];
-  unsigned long frac = (unsigned long)tmp;
-  diff = tmp - frac;
 
-  if (diff > 0.5) {
-    ++frac;
-    // handle rollover, e.g. case 0.99 with prec 1 is 1.0
-    if (frac >= pow10[prec]) {
-      frac = 0;
-      ++whole;
+// internal flush of the staged output, or of the complete lines only
+static void _out_block_flush(out_block_type* block, bool lines)
+{
+  size_t n = block->len;
+  if (lines) {
+    while (n && (block->data[n - 1U] != '\n')) {
+      n--;
     }
   }
-  else if (diff < 0.5) {
+  if (n) {
+    _putblock(block->data, n);
+    memmove(block->data, block->data + n, block->len - n);
+    block->len -= n;
   }
-  else if ((frac == 0U) || (frac & 1U)) {
-    // if halfway, round up if odd OR if last digit is 0
-    ++frac;
+}
+
+
+// internal _putblock wrapper, flushes on full buffer and after each newline,
+// a thread buffer flushes only its complete lines when it is full
+static void _out_block(const char* data, size_t len, void* buffer, size_t idx, size_t maxlen)
+{
+  out_block_type* block = (out_block_type*)buffer;
+  (void)idx; (void)maxlen;
+
+  // a 0 is only ever output on its own (termination or %c), skip it like _out_char
+  if ((len == 1U) && !*data) {
+    return;
   }
 
-  if (prec == 0U) {
-    diff = value - (double)whole;
-    if ((!(diff < 0.5) || (diff > 0.5)) && (whole & 1)) {
-      // exactly 0.5 and ODD, then round up
-      // 1.5 -> 2, but 2.5 -> 2
-      ++whole;
+  while (len) {
+    // pass big runs through without staging
+    if (!block->len && (len >= block->size)) {
+      _putblock(data, len);
+      return;
     }
-  }
-  else {
-    unsigned int count = prec;
-    // now do fractional part, as an unsigned number
-    while (len < PRINTF_FTOA_BUFFER_SIZE) {
-      --count;
-      buf[len++] = (char)(48U + (frac % 10U));
-      if (!(frac /= 10U)) {
-        break;
+    if (block->len == block->size) {
+      // full thread buffer, a line longer than the buffer is split
+      _out_block_flush(block, true);
+      if (block->len == block->size) {
+        _out_block_flush(block, false);
       }
     }
-    // add extra 0s
-    while ((len < PRINTF_FTOA_BUFFER_SIZE) && (count-- > 0U)) {
-      buf[len++] = '0';
+    size_t n = block->size - block->len;
+    if (n > len) {
+      n = len;
     }
-    if (len < PRINTF_FTOA_BUFFER_SIZE) {
-      // add decimal
-      buf[len++] = '.';
+    const char* nl = block->keep ? NULL : (const char*)memchr(data, '\n', n);
+    if (nl) {
+      n = (size_t)(nl - data) + 1U;
+    }
+    memcpy(block->data + block->len, data, n);
+    block->len += n;
+    data       += n;
+    len        -= n;
+    if (!block->keep && (nl || (block->len == block->size))) {
+      _out_block_flush(block, false);
     }
   }
+}
 
-  // do whole part, number is reversed
-  while (len < PRINTF_FTOA_BUFFER_SIZE) {
-    buf[len++] = (char)(48 + (whole % 10));
-    if (!(whole /= 10)) {
-      break;
+
+#if defined(PRINTF_SUPPORT_THREAD_BUFFER)
+// line buffer of the calling thread, set by printf_thread_buffer()
+static PRINTF_THREAD_LOCAL out_block_type _thread_block;
+#endif
+#endif  // PRINTF_SUPPORT_PUTBLOCK
+
+
+// output 'count' pad characters, 'ch' is either ' ' or '0'
+static size_t _out_fill(out_fct_type out, char* buffer, size_t idx, size_t maxlen, char ch, size_t count)
+{
+  static const char spaces[] = "                                ";  // 32 spaces
+  static const char zeros[]  = "00000000000000000000000000000000";  // 32 zeros
+
+  if (out == _out_buffer) {
+    // fill the destination buffer directly
+    if (idx < maxlen) {
+      memset(buffer + idx, ch, count < maxlen - idx ? count : maxlen - idx);
     }
+    return idx + count;
+  }
+  if (out == _out_null) {
+    // measuring only
+    return idx + count;
   }
 
-  // pad leading zeros
-  if (!(flags & FLAGS_LEFT) && (flags & FLAGS_ZEROPAD)) {
-    if (width && (negative || (flags & (FLAGS_PLUS | FLAGS_SPACE)))) {
-      width--;
-    }
-    while ((len < width) && (len < PRINTF_FTOA_BUFFER_SIZE)) {
-      buf[len++] = '0';
-    }
+  // emit runs of a constant block through the output function
+  const char* block = (ch == '0') ? zeros : spaces;
+  while (count) {
+    const size_t n = count < sizeof(spaces) - 1U ? count : sizeof(spaces) - 1U;
+    _out_ref(out, block, n, buffer, idx, maxlen);
+    idx   += n;
+    count -= n;
   }
+  return idx;
+}
 
-  if (len < PRINTF_FTOA_BUFFER_SIZE) {
-    if (negative) {
-      buf[len++] = '-';
-    }
-    else if (flags & FLAGS_PLUS) {
-      buf[len++] = '+';  // ignore the space if the '+' exists
+
+// internal secure strlen
+// \return The length of the string (excluding the terminating 0) limited by 'maxsize'
+static inline unsigned int _strnlen_s(const char* str, size_t maxsize)
+{
+  const char* s;
+  for (s = str; *s && maxsize--; ++s);
+  return (unsigned int)(s - str);
+}
+
+
+// internal scan for the end of a literal text run
+// \return The number of characters before the next '%' or the terminating 0
+static inline size_t _strlit(const char* str)
+{
+  const char* s = str;
+#if defined(PRINTF_SUPPORT_FAST_SCAN)
+  const uintptr_t ones = (uintptr_t)-1 / 0xFFU;     // 0x01 in every byte
+  const uintptr_t pct  = ones * (uintptr_t)'%';     // '%' in every byte
+  // walk to the next word boundary
+  while ((uintptr_t)s % sizeof(uintptr_t)) {
+    if (!*s || (*s == '%')) {
+      return (size_t)(s - str);
     }
-    else if (flags & FLAGS_SPACE) {
-      buf[len++] = ' ';
+    s++;
+  }
+  // test a whole word per step for a 0 or '%' byte
+  for (;;) {
+    uintptr_t w;
+    memcpy(&w, s, sizeof(w));
+    const uintptr_t x = w ^ pct;
+    if ((((w - ones) & ~w) | ((x - ones) & ~x)) & (ones << 7U)) {
+      break;
     }
+    s += sizeof(w);
+  }
+#endif
+  // locate the exact position byte-wise
+  while (*s && (*s != '%')) {
+    s++;
   }
+  return (size_t)(s - str);
+}
 
-  return _out_rev(out, buffer, idx, maxlen, buf, len, width, flags);
+
+// internal test if char is a digit (0-9)
+// \return true if char is a digit
+static inline bool _is_digit(char ch)
+{
+  return (ch >= '0') && (ch <= '9');
 }
 
 
-#if defined(PRINTF_SUPPORT_EXPONENTIAL)
-// internal ftoa variant for exponential floating-point type, contributed by Martijn Jasperse <m.jasperse@gmail.com>
-static size_t _etoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags)
+// internal ASCII string to unsigned int conversion
+static unsigned int _atoi(const char** str)
 {
-  // check for NaN and special values
-  if ((value != value) || (value > DBL_MAX) || (value < -DBL_MAX)) {
-    return _ftoa(out, buffer, idx, maxlen, value, prec, width, flags);
+  unsigned int i = 0U;
+  while (_is_digit(**str)) {
+    i = i * 10U + (unsigned int)(*((*str)++) - '0');
   }
+  return i;
+}
 
-  // determine the sign
-  const bool negative = value < 0;
-  if (negative) {
-    value = -value;
-  }
 
-  // default precision
-  if (!(flags & FLAGS_PRECISION)) {
-    prec = PRINTF_DEFAULT_FLOAT_PRECISION;
+// output the specified string, taking care of any space-padding
+static size_t _out_str(out_fct_type out, char* buffer, size_t idx, size_t maxlen, const char* str, size_t len, unsigned int width, unsigned int flags)
+{
+  // pad spaces up to given width
+  if (!(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD) && (len < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - len);
   }
 
-  // determine the decimal exponent
-  // based on the algorithm by David Gay (https://www.ampl.com/netlib/fp/dtoa.c)
-  union {
-    uint64_t U;
-    double   F;
-  } conv;
+  // output string
+  _out_ref(out, str, len, buffer, idx, maxlen);
+  idx += len;
 
-  conv.F = value;
-  int exp2 = (int)((conv.U >> 52U) & 0x07FFU) - 1023;           // effectively log2
-  conv.U = (conv.U & ((1ULL << 52U) - 1U)) | (1023ULL << 52U);  // drop the exponent so conv.F is now in [1,2)
-  // now approximate log10 from the log2 integer part and an expansion of ln around 1.5
-  int expval = (int)(0.1760912590558 + exp2 * 0.301029995663981 + (conv.F - 1.5) * 0.289529654602168);
-  // now we want to compute 10^expval but we want to be sure it won't overflow
-  exp2 = (int)(expval * 3.321928094887362 + 0.5);
-  const double z  = expval * 2.302585092994046 - exp2 * 0.6931471805599453;
-  const double z2 = z * z;
-  conv.U = (uint64_t)(exp2 + 1023) << 52U;
-  // compute exp(z) using continued fractions, see https://en.wikipedia.org/wiki/Exponential_function#Continued_fractions_for_ex
-  conv.F *= 1 + 2 * z / (2 - z + (z2 / (6 + (z2 / (10 + z2 / 14)))));
-  // correct for rounding errors
-  if (value < conv.F) {
-    expval--;
-    conv.F /= 10;
-  }
-
-  // the exponent format is "%+03d" and largest value is "307", so set aside 4-5 characters
-  unsigned int minwidth = ((expval < 100) && (expval > -100)) ? 4U : 5U;
+  // append pad spaces up to given width
+  if ((flags & FLAGS_LEFT) && (len < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - len);
+  }
 
-  // in "%g" mode, "prec" is the number of *significant figures* not decimals
-  if (flags & FLAGS_ADAPT_EXP) {
-    // do we want to fall-back to "%f" mode?
-    if ((value >= 1e-4) && (value < 1e6)) {
-      if ((int)prec > expval) {
-        prec = (unsigned)((int)prec - expval - 1);
-      }
-      else {
-        prec = 0;
-      }
-      flags |= FLAGS_PRECISION;   // make sure _ftoa respects precision
-      // no characters in exponent
-      minwidth = 0U;
-      expval   = 0;
-    }
-    else {
-      // we use one sigfig for the whole part
-      if ((prec > 0) && (flags & FLAGS_PRECISION)) {
-        --prec;
-      }
-    }
+  return idx;
+}
+
+
+// output the specified number, preceded by its sign/prefix and 'zeros'
+// leading zeros, taking care of any space-padding
+static size_t _out_num(out_fct_type out, char* buffer, size_t idx, size_t maxlen, const char* prefix, size_t plen, size_t zeros, const char* buf, size_t len, unsigned int width, unsigned int flags)
+{
+  const size_t total = plen + zeros + len;
+
+  if (out == _out_null) {
+    // measuring only, the number is not output
+    return idx + ((total < width) && ((flags & FLAGS_LEFT) || !(flags & FLAGS_ZEROPAD)) ? width : total);
   }
 
-  // will everything fit?
-  unsigned int fwidth = width;
-  if (width > minwidth) {
-    // we didn't fall-back so subtract the characters required for the exponent
-    fwidth -= minwidth;
-  } else {
-    // not enough characters, so go back to default sizing
-    fwidth = 0U;
+  // pad spaces up to given width
+  if (!(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD) && (total < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - total);
   }
-  if ((flags & FLAGS_LEFT) && minwidth) {
-    // if we're padding on the right, DON'T pad the floating part
-    fwidth = 0U;
+
+  // sign and prefix
+  if (plen) {
+    out(prefix, plen, buffer, idx, maxlen);
+    idx += plen;
   }
 
-  // rescale the float value
-  if (expval) {
-    value /= conv.F;
+  // leading zeros
+  if (zeros) {
+    idx = _out_fill(out, buffer, idx, maxlen, '0', zeros);
   }
 
-  // output the floating part
-  const size_t start_idx = idx;
-  idx = _ftoa(out, buffer, idx, maxlen, negative ? -value : value, prec, fwidth, flags & ~FLAGS_ADAPT_EXP);
+  // number
+  out(buf, len, buffer, idx, maxlen);
+  idx += len;
 
-  // output the exponent part
-  if (minwidth) {
-    // output the exponential symbol
-    out((flags & FLAGS_UPPERCASE) ? 'E' : 'e', buffer, idx++, maxlen);
-    // output the exponent value
-    idx = _ntoa_long(out, buffer, idx, maxlen, (expval < 0) ? -expval : expval, expval < 0, 10, 0, minwidth-1, FLAGS_ZEROPAD | FLAGS_PLUS);
-    // might need to right-pad spaces
-    if (flags & FLAGS_LEFT) {
-      while (idx - start_idx < width) out(' ', buffer, idx++, maxlen);
-    }
+  // append pad spaces up to given width
+  if ((flags & FLAGS_LEFT) && (total < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - total);
   }
+
   return idx;
 }
-#endif  // PRINTF_SUPPORT_EXPONENTIAL
-#endif  // PRINTF_SUPPORT_FLOAT
 
 
-// internal vsnprintf
-static int _vsnprintf(out_fct_type out, char* buffer, const size_t maxlen, const char* format, va_list va)
+// internal layout of a formatted integer: the sign/prefix, the count of leading
+// zeros and the count of digits (reduced if the hash prefix needs room)
+// \return The length of the prefix
+static size_t _ntoa_layout(char* prefix, size_t* len, size_t* zeros, bool negative, unsigned int base, unsigned int prec, unsigned int* width, unsigned int flags)
 {
-  unsigned int flags, width, precision, n;
-  size_t idx = 0U;
+  size_t plen = 0U;
+  *zeros = 0U;
 
-  if (!buffer) {
-    // use null output function
-    out = _out_null;
+  // count leading zeros
+  if (!(flags & FLAGS_LEFT)) {
+    if (*width && (flags & FLAGS_ZEROPAD) && (negative || (flags & (FLAGS_PLUS | FLAGS_SPACE)))) {
+      (*width)--;
+    }
+    if (*len < prec) {
+      *zeros = prec - *len;
+    }
+    if ((flags & FLAGS_ZEROPAD) && (*len + *zeros < *width)) {
+      *zeros = *width - *len;
+    }
   }
 
-  while (*format)
-  {
-    // format specifier?  %[flags][width][.precision][length]
-    if (*format != '%') {
-      // no
-      out(*format, buffer, idx++, maxlen);
-      format++;
-      continue;
+  // sign
+  if (negative) {
+    prefix[plen++] = '-';
+  }
+  else if (flags & FLAGS_PLUS) {
+    prefix[plen++] = '+';  // ignore the space if the '+' exists
+  }
+  else if (flags & FLAGS_SPACE) {
+    prefix[plen++] = ' ';
+  }
+
+  // handle hash
+  if (flags & FLAGS_HASH) {
+    // make room for the prefix by dropping leading zeros (or digits) in a full field
+    if (!(flags & FLAGS_PRECISION) && (*len + *zeros) && ((*len + *zeros == prec) || (*len + *zeros == *width))) {
+      if (*zeros) (*zeros)--; else (*len)--;
+      if ((*len + *zeros) && (base == 16U)) {
+        if (*zeros) (*zeros)--; else (*len)--;
+      }
     }
-    else {
-      // yes, evaluate it
-      format++;
+    prefix[plen++] = '0';
+    if (base == 16U) {
+      prefix[plen++] = (flags & FLAGS_UPPERCASE) ? 'X' : 'x';
+    }
+    else if (base == 2U) {
+      prefix[plen++] = 'b';
     }
+  }
 
-    // evaluate flags
-    flags = 0U;
-    do {
-      switch (*format) {
-        case '0': flags |= FLAGS_ZEROPAD; format++; n = 1U; break;
-        case '-': flags |= FLAGS_LEFT;    format++; n = 1U; break;
-        case '+': flags |= FLAGS_PLUS;    format++; n = 1U; break;
-        case ' ': flags |= FLAGS_SPACE;   format++; n = 1U; break;
-        case '#': flags |= FLAGS_HASH;    format++; n = 1U; break;
-        default :                                   n = 0U; break;
-      }
-    } while (n);
+  return plen;
+}
 
-    // evaluate width field
-    width = 0U;
-    if (_is_digit(*format)) {
-      width = _atoi(&format);
+
+// internal forward output of a formatted integer field into a linear buffer:
+// writes the padding, prefix and leading zeros, the caller writes the digits
+// \return Pointer to the room for the 'len' digits, NULL if the field does not fit into the buffer
+static char* _out_field(char* buffer, size_t* idx, size_t maxlen, const char* prefix, size_t plen, size_t zeros, size_t len, unsigned int width, unsigned int flags)
+{
+  const size_t total = plen + zeros + len;
+  const size_t pad   = ((total < width) && ((flags & FLAGS_LEFT) || !(flags & FLAGS_ZEROPAD))) ? width - total : 0U;
+  if ((*idx >= maxlen) || (total + pad > maxlen - *idx)) {
+    return NULL;
+  }
+
+  char* dst = buffer + *idx;
+  *idx += total + pad;
+  if (pad && !(flags & FLAGS_LEFT)) {
+    memset(dst, ' ', pad);
+    dst += pad;
+  }
+  for (size_t i = 0U; i < plen; i++) {
+    *dst++ = prefix[i];
+  }
+  if (zeros) {
+    memset(dst, '0', zeros);
+    dst += zeros;
+  }
+  if (pad && (flags & FLAGS_LEFT)) {
+    memset(dst + len, ' ', pad);
+  }
+  return dst;
+}
+
+
+// two digit decimal lookup table "00".."99"
+static const char _dec_digits[] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+
+// hexadecimal digits
+static const char _hex_digits[]       = "0123456789abcdef";
+static const char _hex_digits_upper[] = "0123456789ABCDEF";
+
+
+#if defined(PRINTF_SUPPORT_SWAR_DIGITS)
+// internal conversion of 32 bits to 8 hex digits at once: the nibbles are
+// spread to the bytes of a 64 bit word and converted to ASCII in parallel
+static inline void _hex8(char* dst, uint32_t value, unsigned int flags)
+{
+  uint64_t x = value;
+  x = ((x & 0xFFFF0000ULL) << 16U) | (x & 0x0000FFFFULL);
+  x = ((x & 0x0000FF000000FF00ULL) << 8U) | (x & 0x000000FF000000FFULL);
+  x = ((x & 0x00F000F000F000F0ULL) << 4U) | (x & 0x000F000F000F000FULL);
+  // nibbles > 9 get the offset from '9' + 1 to 'A' or 'a'
+  const uint64_t alpha = ((x + 0x0606060606060606ULL) >> 4U) & 0x0101010101010101ULL;
+  x += 0x3030303030303030ULL + alpha * ((flags & FLAGS_UPPERCASE) ? 7U : 39U);
+  // the most significant digit is in the low byte after swapping (little endian)
+  x = __builtin_bswap64(x);
+  memcpy(dst, &x, sizeof(x));
+}
+
+
+// internal conversion of a value < 10^8 to 8 decimal digits at once, without
+// a loop: the value is split into 4 digit halves, 2 digit quarters and digits,
+// each step in all lanes of a 64 bit word in parallel (division by multiplication)
+static inline void _dec8(char* dst, uint32_t value)
+{
+  uint64_t x = (value / 10000U) | ((uint64_t)(value % 10000U) << 32U);
+  uint64_t q = ((x * 10486U) >> 20U) & 0x0000007F0000007FULL;   // x / 100 in 32 bit lanes
+  x = q | ((x - q * 100U) << 16U);
+  q = ((x * 205U) >> 11U) & 0x000F000F000F000FULL;              // x / 10 in 16 bit lanes
+  x = q | ((x - q * 10U) << 8U);
+  // the most significant digit is in the low byte (little endian)
+  x += 0x3030303030303030ULL;
+  memcpy(dst, &x, sizeof(x));
+}
+#endif
+
+
+// powers of 10 for counting decimal digits
+static const unsigned long long _pow10[] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+  10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+
+// internal count of the digits of 'value' in 'base', without converting it
+static inline size_t _ntoa_len_long(unsigned long value, unsigned long base)
+{
+  size_t len;
+  if (base == 10U) {
+#if defined(__GNUC__)
+    // estimate log10 from the number of significant bits, correct it by the power of ten table
+    len = ((sizeof(value) * 8U - (size_t)__builtin_clzl(value | 1U)) * 1233U) >> 12U;
+    return (value >= _pow10[len]) ? len + 1U : (len ? len : 1U);
+#else
+    for (len = 1U; (len < sizeof(_pow10) / sizeof(_pow10[0])) && (value >= _pow10[len]); len++);
+    return len;
+#endif
+  }
+
+  // power of 2 base: digits from the number of significant bits
+#if defined(__GNUC__)
+  len = sizeof(value) * 8U - (size_t)__builtin_clzl(value | 1U);
+#else
+  for (len = 1U; value >>= 1U; len++);
+#endif
+  switch (base) {
+    case 16U : return (len + 3U) / 4U;
+    case  8U : return (len + 2U) / 3U;
+    default  : return len;
+  }
+}
+
+
+// internal conversion of the 'len' least significant digits of 'value' in 'base',
+// written from the end of 'dst' backwards, so no reversal is needed
+static inline void _ntoa_digits_long(char* dst, size_t len, unsigned long value, unsigned long base, unsigned int flags)
+{
+  if (base == 10U) {
+#if defined(PRINTF_SUPPORT_SWAR_DIGITS)
+    // decimal: 8 digits at once
+    while (len >= 8U) {
+      len -= 8U;
+      _dec8(dst + len, (uint32_t)(value % 100000000U));
+      value /= 100000000U;
     }
-    else if (*format == '*') {
-      const int w = va_arg(va, int);
-      if (w < 0) {
-        flags |= FLAGS_LEFT;    // reverse padding
-        width = (unsigned int)-w;
-      }
-      else {
-        width = (unsigned int)w;
-      }
-      format++;
+#endif
+    // decimal: two digits per step from the lookup table, the divisor is constant
+    while (len >= 2U) {
+      const char* digits = &_dec_digits[2U * (value % 100U)];
+      value /= 100U;
+      dst[--len] = digits[1];
+      dst[--len] = digits[0];
+    }
+    if (len) {
+      dst[0] = (char)('0' + (char)(value % 10U));
     }
+    return;
+  }
 
-    // evaluate precision field
-    precision = 0U;
-    if (*format == '.') {
-      flags |= FLAGS_PRECISION;
-      format++;
-      if (_is_digit(*format)) {
-        precision = _atoi(&format);
-      }
-      else if (*format == '*') {
-        const int prec = (int)va_arg(va, int);
-        precision = prec > 0 ? (unsigned int)prec : 0U;
-        format++;
+  // power of 2 base: shift and mask, the case is selected once
+  const char* digits = (flags & FLAGS_UPPERCASE) ? _hex_digits_upper : _hex_digits;
+  const unsigned int shift = (base == 16U) ? 4U : (base == 8U) ? 3U : 1U;
+#if defined(PRINTF_SUPPORT_SWAR_DIGITS)
+  if (base == 16U) {
+    // 8 digits at once
+    while (len >= 8U) {
+      len -= 8U;
+      _hex8(dst + len, (uint32_t)value, flags);
+      value = (value >> 16U) >> 16U;
+    }
+  }
+#endif
+  while (len) {
+    dst[--len] = digits[value & (base - 1U)];
+    value >>= shift;
+  }
+}
+
+
+// internal itoa for 'long' type
+static size_t _ntoa_long(out_fct_type out, char* buffer, size_t idx, size_t maxlen, unsigned long value, bool negative, unsigned long base, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  char   buf[PRINTF_NTOA_BUFFER_SIZE];
+  char   prefix[3];
+  size_t len = 0U;
+  size_t zeros;
+
+  // no hash for 0 values
+  if (!value) {
+    flags &= ~FLAGS_HASH;
+  }
+
+  // count the digits, none if precision == 0 and value == 0
+  if (!(flags & FLAGS_PRECISION) || value) {
+    len = _ntoa_len_long(value, base);
+    len = len < PRINTF_NTOA_BUFFER_SIZE ? len : PRINTF_NTOA_BUFFER_SIZE;
+  }
+  const size_t plen = _ntoa_layout(prefix, &len, &zeros, negative, (unsigned int)base, prec, &width, flags);
+
+  if (out == _out_buffer) {
+    // linear buffer: write the field forward, the digits directly to their place
+    char* dst = _out_field(buffer, &idx, maxlen, prefix, plen, zeros, len, width, flags);
+    if (dst) {
+      _ntoa_digits_long(dst, len, value, base, flags);
+      return idx;
+    }
+    // the field is clipped by the end of the buffer
+  }
+
+  if (out != _out_null) {
+    _ntoa_digits_long(buf, len, value, base, flags);
+  }
+  return _out_num(out, buffer, idx, maxlen, prefix, plen, zeros, buf, len, width, flags);
+}
+
+
+// internal 64 bit division by 10^9 for 32 bit targets, which have no 64 bit divide
+// instruction and would call a library routine: multiplication by the reciprocal
+// 2^75 / 5^9, the high half of the product is composed of 32 x 32 bit products
+// (the float conversion uses it as well, so it does not depend on long long support)
+static inline unsigned long long _div_pow10_9(unsigned long long value)
+{
+  const unsigned long long magic = 0x44B82FA09B5A53ULL;
+  value >>= 9U;   // 10^9 = 2^9 * 5^9
+  const unsigned long long lo = (unsigned long long)(uint32_t)value * (uint32_t)magic;
+  const unsigned long long mid1 = (unsigned long long)(uint32_t)(value >> 32U) * (uint32_t)magic;
+  const unsigned long long mid2 = (unsigned long long)(uint32_t)value * (uint32_t)(magic >> 32U);
+  const unsigned long long hi = (unsigned long long)(uint32_t)(value >> 32U) * (uint32_t)(magic >> 32U);
+  const unsigned long long cross = (lo >> 32U) + (uint32_t)mid1 + mid2;
+  return (hi + (mid1 >> 32U) + (cross >> 32U)) >> 11U;
+}
+
+
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+// internal count of the digits of 'value' in 'base', without converting it
+static inline size_t _ntoa_len_long_long(unsigned long long value, unsigned long long base)
+{
+  size_t len;
+  if (base == 10U) {
+#if defined(__GNUC__)
+    // estimate log10 from the number of significant bits, correct it by the power of ten table
+    len = ((sizeof(value) * 8U - (size_t)__builtin_clzll(value | 1U)) * 1233U) >> 12U;
+    return (value >= _pow10[len]) ? len + 1U : (len ? len : 1U);
+#else
+    for (len = 1U; (len < sizeof(_pow10) / sizeof(_pow10[0])) && (value >= _pow10[len]); len++);
+    return len;
+#endif
+  }
+
+  // power of 2 base: digits from the number of significant bits
+#if defined(__GNUC__)
+  len = sizeof(value) * 8U - (size_t)__builtin_clzll(value | 1U);
+#else
+  for (len = 1U; value >>= 1U; len++);
+#endif
+  switch (base) {
+    case 16U : return (len + 3U) / 4U;
+    case  8U : return (len + 2U) / 3U;
+    default  : return len;
+  }
+}
+
+
+// internal conversion of the 'len' least significant digits of 'value' in 'base',
+// written from the end of 'dst' backwards, so no reversal is needed
+static inline void _ntoa_digits_long_long(char* dst, size_t len, unsigned long long value, unsigned long long base, unsigned int flags)
+{
+  if (base == 10U) {
+    if (sizeof(unsigned long) < sizeof(unsigned long long)) {
+      // 32 bit target: peel off 9 digit chunks by one 64 bit division each and
+      // convert the chunks by the native 32 bit 'long' conversion
+      while (len > 9U) {
+        const unsigned long long quot = _div_pow10_9(value);
+        len -= 9U;
+        _ntoa_digits_long(dst + len, 9U, (unsigned long)(value - quot * 1000000000U), 10U, flags);
+        value = quot;
       }
+      _ntoa_digits_long(dst, len, (unsigned long)value, 10U, flags);
+      return;
+    }
+#if defined(PRINTF_SUPPORT_SWAR_DIGITS)
+    // decimal: 8 digits at once
+    while (len >= 8U) {
+      len -= 8U;
+      _dec8(dst + len, (uint32_t)(value % 100000000U));
+      value /= 100000000U;
+    }
+#endif
+    // decimal: two digits per step from the lookup table, the divisor is constant
+    while (len >= 2U) {
+      const char* digits = &_dec_digits[2U * (value % 100U)];
+      value /= 100U;
+      dst[--len] = digits[1];
+      dst[--len] = digits[0];
     }
+    if (len) {
+      dst[0] = (char)('0' + (char)(value % 10U));
+    }
+    return;
+  }
 
-    // evaluate length field
-    switch (*format) {
-      case 'l' :
-        flags |= FLAGS_LONG;
-        format++;
-        if (*format == 'l') {
-          flags |= FLAGS_LONG_LONG;
-          format++;
-        }
-        break;
-      case 'h' :
-        flags |= FLAGS_SHORT;
-        format++;
-        if (*format == 'h') {
-          flags |= FLAGS_CHAR;
-          format++;
-        }
-        break;
-#if defined(PRINTF_SUPPORT_PTRDIFF_T)
-      case 't' :
-        flags |= (sizeof(ptrdiff_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
-        format++;
-        break;
+  // power of 2 base: shift and mask, the case is selected once
+  const char* digits = (flags & FLAGS_UPPERCASE) ? _hex_digits_upper : _hex_digits;
+  const unsigned int shift = (base == 16U) ? 4U : (base == 8U) ? 3U : 1U;
+#if defined(PRINTF_SUPPORT_SWAR_DIGITS)
+  if (base == 16U) {
+    // 8 digits at once
+    while (len >= 8U) {
+      len -= 8U;
+      _hex8(dst + len, (uint32_t)value, flags);
+      value = (value >> 16U) >> 16U;
+    }
+  }
 #endif
-      case 'j' :
-        flags |= (sizeof(intmax_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
-        format++;
-        break;
-      case 'z' :
-        flags |= (sizeof(size_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
-        format++;
-        break;
-      default :
-        break;
+  while (len) {
+    dst[--len] = digits[value & (base - 1U)];
+    value >>= shift;
+  }
+}
+
+
+// internal itoa for 'long long' type
+static size_t _ntoa_long_long(out_fct_type out, char* buffer, size_t idx, size_t maxlen, unsigned long long value, bool negative, unsigned long long base, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  char   buf[PRINTF_NTOA_BUFFER_SIZE];
+  char   prefix[3];
+  size_t len = 0U;
+  size_t zeros;
+
+  // no hash for 0 values
+  if (!value) {
+    flags &= ~FLAGS_HASH;
+  }
+
+  // count the digits, none if precision == 0 and value == 0
+  if (!(flags & FLAGS_PRECISION) || value) {
+    len = _ntoa_len_long_long(value, base);
+    len = len < PRINTF_NTOA_BUFFER_SIZE ? len : PRINTF_NTOA_BUFFER_SIZE;
+  }
+  const size_t plen = _ntoa_layout(prefix, &len, &zeros, negative, (unsigned int)base, prec, &width, flags);
+
+  if (out == _out_buffer) {
+    // linear buffer: write the field forward, the digits directly to their place
+    char* dst = _out_field(buffer, &idx, maxlen, prefix, plen, zeros, len, width, flags);
+    if (dst) {
+      _ntoa_digits_long_long(dst, len, value, base, flags);
+      return idx;
     }
+    // the field is clipped by the end of the buffer
+  }
+
+  if (out != _out_null) {
+    _ntoa_digits_long_long(buf, len, value, base, flags);
+  }
+  return _out_num(out, buffer, idx, maxlen, prefix, plen, zeros, buf, len, width, flags);
+}
+#endif  // PRINTF_SUPPORT_LONG_LONG
+
+
+#if defined(PRINTF_SUPPORT_INT128)
+// 10^19, the largest power of 10 of 64 bit
+#define POW10_19  10000000000000000000ULL
+
+
+// internal division of a 128 bit value by 10^19, without a 128 bit division: the
+// value is divided by 2^19 by a shift and by 5^19 by multiplication with its
+// reciprocal 2^152 / 5^19 (rounded up), which is exact for all 109 bit dividends
+static inline uint128_type _div_pow10_19(uint128_type value)
+{
+  const unsigned long long mh = 0xEC1E4A7DB69ULL, ml = 0x561A52B31E9E3D07ULL;
+  const uint128_type x = value >> 19U;
+  const unsigned long long xh = (unsigned long long)(x >> 64U), xl = (unsigned long long)x;
+  const uint128_type p0  = (uint128_type)xl * ml;
+  const uint128_type p1  = (uint128_type)xl * mh;
+  const uint128_type p2  = (uint128_type)xh * ml;
+  const uint128_type p3  = (uint128_type)xh * mh;
+  const uint128_type mid = (p0 >> 64U) + (unsigned long long)p1 + (unsigned long long)p2;
+  return (p3 + (p1 >> 64U) + (p2 >> 64U) + (mid >> 64U)) >> 24U;
+}
+
+
+// internal count of the digits of a 128 bit 'value' in 'base', without converting it
+static inline size_t _ntoa_len_int128(uint128_type value, unsigned long long base)
+{
+  const unsigned long long high = (unsigned long long)(value >> 64U);
+  if (!high) {
+    return _ntoa_len_long_long((unsigned long long)value, base);
+  }
+  const size_t bits = 128U - (size_t)__builtin_clzll(high);
+  if (base == 10U) {
+    // estimate log10 from the number of significant bits (at least 19 here),
+    // correct it by the power of ten 10^19 * 10^(len - 19)
+    const size_t len = (bits * 1233U) >> 12U;
+    return (value >= (uint128_type)_pow10[len - 19U] * POW10_19) ? len + 1U : len;
+  }
+  // power of 2 base: digits from the number of significant bits
+  switch (base) {
+    case 16U : return (bits + 3U) / 4U;
+    case  8U : return (bits + 2U) / 3U;
+    default  : return bits;
+  }
+}
+
+
+// internal conversion of the 'len' least significant digits of a 128 bit 'value',
+// in chunks by the 64 bit conversion, so there is no 128 bit division per digit
+static inline void _ntoa_digits_int128(char* dst, size_t len, uint128_type value, unsigned long long base, unsigned int flags)
+{
+  if (base == 10U) {
+    // 19 digit chunks, at most two divisions for 39 digits
+    while (len > 19U) {
+      const uint128_type quot = _div_pow10_19(value);
+      len -= 19U;
+      _ntoa_digits_long_long(dst + len, 19U, (unsigned long long)(value - quot * POW10_19), 10U, flags);
+      value = quot;
+    }
+  }
+  else if (base != 8U) {
+    // hex and binary digits do not cross the 64 bit halves
+    const size_t half = (base == 16U) ? 16U : 64U;
+    if (len > half) {
+      len -= half;
+      _ntoa_digits_long_long(dst + len, half, (unsigned long long)value, base, flags);
+      value >>= 64U;
+    }
+  }
+  else {
+    // octal
+    while (len > 21U) {
+      dst[--len] = (char)('0' + (char)(value & 7U));
+      value >>= 3U;
+    }
+  }
+  _ntoa_digits_long_long(dst, len, (unsigned long long)value, base, flags);
+}
+
+
+// internal itoa for 128 bit type
+static size_t _ntoa_int128(out_fct_type out, char* buffer, size_t idx, size_t maxlen, uint128_type value, bool negative, unsigned long long base, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  char   buf[sizeof(value) * 8U];   // room for the binary digits
+  char   prefix[3];
+  size_t len = 0U;
+  size_t zeros;
+
+  // no hash for 0 values
+  if (!value) {
+    flags &= ~FLAGS_HASH;
+  }
+
+  // count the digits, none if precision == 0 and value == 0
+  if (!(flags & FLAGS_PRECISION) || value) {
+    len = _ntoa_len_int128(value, base);
+  }
+  const size_t plen = _ntoa_layout(prefix, &len, &zeros, negative, (unsigned int)base, prec, &width, flags);
+
+  if (out == _out_buffer) {
+    // linear buffer: write the field forward, the digits directly to their place
+    char* dst = _out_field(buffer, &idx, maxlen, prefix, plen, zeros, len, width, flags);
+    if (dst) {
+      _ntoa_digits_int128(dst, len, value, base, flags);
+      return idx;
+    }
+    // the field is clipped by the end of the buffer
+  }
+
+  if (out != _out_null) {
+    _ntoa_digits_int128(buf, len, value, base, flags);
+  }
+  return _out_num(out, buffer, idx, maxlen, prefix, plen, zeros, buf, len, width, flags);
+}
+#endif  // PRINTF_SUPPORT_INT128
+
+
+#if defined(PRINTF_SUPPORT_FLOAT)
+
+// count of 32 bit limbs for the exact conversion, enough for the 1024 whole
+// bits and the 1074 fraction bits of a double
+#define FTOA_LIMBS   34U
+
+// count of 9 digit chunks of the largest whole part (309 digits)
+#define FTOA_CHUNKS  35U
+
+// digits up to this count are kept from the rounding, longer ones are read again
+#define FTOA_DIGITS  40U
+
+
+// internal fixed point fraction, the value is limb[lo..hi) / 2^(32 * n),
+// the limbs out of [lo, hi) are 0
+typedef struct {
+  uint32_t limb[FTOA_LIMBS];
+  size_t   n;
+  size_t   lo;
+  size_t   hi;
+} ftoa_frac_type;
+
+
+// internal exact decimal digits of a double: the whole part in 9 digit chunks
+// (the most significant one with leading zeros), followed by the fraction digits
+typedef struct {
+  uint32_t       chunk[FTOA_CHUNKS];  // whole part, least significant chunk first
+  size_t         chunks;              // count of whole chunks
+  size_t         count;               // count of whole chunks not read yet
+  uint64_t       bits;                // the fraction is bits / 2^k
+  unsigned int   k;
+  ftoa_frac_type frac;                // fraction not read yet
+  char           pend[9];             // digits read ahead
+  size_t         plen;                // count of digits read ahead, at the end of pend
+} ftoa_dec_type;
+
+
+// internal setup of the fraction 'bits' / 2^'k', with bits < 2^k and bits < 2^53
+static void _ftoa_frac_init(ftoa_frac_type* frac, uint64_t bits, unsigned int k)
+{
+  const unsigned int shift = (32U - k % 32U) % 32U;   // aligns the binary point to a limb
+  const uint64_t low = bits << shift;
+  const uint32_t part[3] = { (uint32_t)low, (uint32_t)(low >> 32U), shift ? (uint32_t)(bits >> (64U - shift)) : 0U };
+
+  frac->n  = (k + 31U) / 32U;
+  frac->lo = 0U;
+  frac->hi = 0U;
+  for (size_t i = 0U; (i < 3U) && (i < frac->n); i++) {
+    frac->limb[i] = part[i];
+    if (part[i]) {
+      frac->lo = frac->hi ? frac->lo : i;
+      frac->hi = i + 1U;
+    }
+  }
+}
+
+
+// internal multiplication of the fraction by 'factor' <= 10^9
+// \return The whole part, which is removed from the fraction
+static uint32_t _ftoa_frac_next(ftoa_frac_type* frac, uint32_t factor)
+{
+  uint64_t carry = 0U;
+  for (size_t i = frac->lo; i < frac->hi; i++) {
+    carry += (uint64_t)frac->limb[i] * factor;
+    frac->limb[i] = (uint32_t)carry;
+    carry >>= 32U;
+  }
+  if (carry && (frac->hi < frac->n)) {
+    // the fraction grows, but stays below 1
+    frac->limb[frac->hi++] = (uint32_t)carry;
+    carry = 0U;
+  }
+  while ((frac->lo < frac->hi) && !frac->limb[frac->lo]) {
+    frac->lo++;
+  }
+  return (uint32_t)carry;
+}
+
+
+// internal conversion of the whole number in 'n' limbs to 9 digit chunks,
+// least significant first, the limbs are destroyed
+// \return The count of chunks
+static size_t _ftoa_chunks(uint32_t* chunk, uint32_t* limb, size_t n)
+{
+  size_t count = 0U;
+  while (n && !limb[n - 1U]) {
+    n--;
+  }
+  while (n) {
+    uint64_t rem = 0U;
+    for (size_t i = n; i-- > 0U;) {
+      rem = (rem << 32U) | limb[i];
+      const uint64_t quot = _div_pow10_9(rem);
+      limb[i] = (uint32_t)quot;
+      rem -= quot * 1000000000U;
+    }
+    chunk[count++] = (uint32_t)rem;
+    while (n && !limb[n - 1U]) {
+      n--;
+    }
+  }
+  return count;
+}
+
+
+// internal restart of reading the digits from the first whole chunk
+static void _ftoa_rewind(ftoa_dec_type* dec)
+{
+  dec->count = dec->chunks;
+  dec->plen  = 0U;
+  _ftoa_frac_init(&dec->frac, dec->bits, dec->k);
+}
+
+
+// internal split of the positive, finite 'value' to mantissa * 2^exp2 and
+// conversion of the whole part to chunks
+static void _ftoa_dec_init(ftoa_dec_type* dec, double value)
+{
+  union {
+    uint64_t U;
+    double   F;
+  } conv;
+  conv.F = value;
+  const unsigned int exponent = (unsigned int)(conv.U >> 52U) & 0x07FFU;
+  uint64_t mantissa = conv.U & ((1ULL << 52U) - 1U);
+  int exp2 = -1074;
+  if (exponent) {
+    mantissa |= 1ULL << 52U;
+    exp2 = (int)exponent - 1075;
+  }
+
+  uint64_t whole = 0U;
+  dec->bits   = 0U;
+  dec->k      = 0U;
+  dec->chunks = 0U;
+  if (exp2 > 11) {
+    // the whole part exceeds 64 bits, no fraction: shift the mantissa in limbs
+    const unsigned int pos = (unsigned int)exp2 / 32U, shift = (unsigned int)exp2 % 32U;
+    const uint64_t low = mantissa << shift;
+    memset(dec->frac.limb, 0, sizeof(dec->frac.limb));
+    dec->frac.limb[pos]      = (uint32_t)low;
+    dec->frac.limb[pos + 1U] = (uint32_t)(low >> 32U);
+    dec->frac.limb[pos + 2U] = shift ? (uint32_t)(mantissa >> (64U - shift)) : 0U;
+    dec->chunks = _ftoa_chunks(dec->chunk, dec->frac.limb, pos + 3U);
+  }
+  else {
+    if (exp2 >= 0) {
+      whole = mantissa << exp2;
+    }
+    else {
+      dec->k    = (unsigned int)-exp2;
+      whole     = (dec->k < 64U) ? mantissa >> dec->k : 0U;
+      dec->bits = (dec->k < 64U) ? mantissa & ((1ULL << dec->k) - 1U) : mantissa;
+    }
+    do {
+      const uint64_t quot = _div_pow10_9(whole);
+      dec->chunk[dec->chunks++] = (uint32_t)(whole - quot * 1000000000U);
+      whole = quot;
+    } while (whole);
+  }
+  _ftoa_rewind(dec);
+}
+
+
+// internal read ahead of the next 9 digits
+static inline void _ftoa_fill(ftoa_dec_type* dec)
+{
+  _ntoa_digits_long(dec->pend, 9U, dec->count ? dec->chunk[--dec->count] : _ftoa_frac_next(&dec->frac, 1000000000U), 10U, 0U);
+  dec->plen = 9U;
+}
+
+
+// internal read of the next 'n' digits to 'dst', they are dropped if 'dst' is NULL
+static void _ftoa_read(ftoa_dec_type* dec, char* dst, size_t n)
+{
+  while (n) {
+    if (!dec->plen) {
+      _ftoa_fill(dec);
+    }
+    const size_t len = (n < dec->plen) ? n : dec->plen;
+    if (dst) {
+      memcpy(dst, dec->pend + 9U - dec->plen, len);
+      dst += len;
+    }
+    dec->plen -= len;
+    n -= len;
+  }
+}
+
+
+// internal test if all digits not read yet are 0
+static bool _ftoa_zero(const ftoa_dec_type* dec)
+{
+  for (size_t i = 0U; i < dec->count; i++) {
+    if (dec->chunk[i]) {
+      return false;
+    }
+  }
+  for (size_t i = 9U - dec->plen; i < 9U; i++) {
+    if (dec->pend[i] != '0') {
+      return false;
+    }
+  }
+  return dec->frac.lo == dec->frac.hi;
+}
+
+
+#if defined(PRINTF_SUPPORT_EXPONENTIAL)
+// internal skip of the leading zeros of a value != 0
+// \return The count of zeros
+static size_t _ftoa_skip(ftoa_dec_type* dec)
+{
+  size_t zeros = 0U;
+  for (;;) {
+    if (!dec->plen) {
+      _ftoa_fill(dec);
+    }
+    if (dec->pend[9U - dec->plen] != '0') {
+      return zeros;
+    }
+    dec->plen--;
+    zeros++;
+  }
+}
+#endif
+
+
+// internal rounding to the next 'len' digits, half to even: the digits are read
+// once to find the trailing run of 9s, which takes the carry if rounded up,
+// and are stored in 'buf' if given
+// \return The count of digits before the run of 9s, which is 0 if all are 9s
+static size_t _ftoa_round(ftoa_dec_type* dec, char* buf, size_t len, bool* round_up)
+{
+  char   digits[9];
+  size_t pos  = 0U;
+  size_t keep = 0U;
+  char   last = '0';
+
+  *round_up = false;
+  while (pos < len) {
+    if (!dec->count && !dec->plen && (dec->frac.lo == dec->frac.hi)) {
+      // the rest is 0
+      if (buf) {
+        memset(buf + pos, '0', len - pos);
+      }
+      return len;
+    }
+    const size_t n = (len - pos < 9U) ? len - pos : 9U;
+    char* const dst = buf ? buf + pos : digits;
+    size_t nines = 0U;
+    _ftoa_read(dec, dst, n);
+    while ((nines < n) && (dst[n - 1U - nines] == '9')) {
+      nines++;
+    }
+    last = dst[n - 1U];
+    pos += n;
+    keep = (nines < n) ? pos - nines : keep;
+  }
+
+  char next;
+  _ftoa_read(dec, &next, 1U);
+  *round_up = (next > '5') || ((next == '5') && (((last - '0') & 1) || !_ftoa_zero(dec)));
+  return *round_up ? keep : len;
+}
+
+
+// internal output of the next 'len' digits with the decimal point before digit 'point',
+// the digits from 'keep' on are 0 and the one before is rounded up if 'round_up',
+// if no digit is kept the carry is a leading '1'
+// the digits come from 'buf' if given, else they are read again
+static size_t _ftoa_out(out_fct_type out, char* buffer, size_t idx, size_t maxlen, ftoa_dec_type* dec, char* buf, size_t len, size_t point, size_t keep, bool round_up)
+{
+  char   digits[9];
+  size_t pos = 0U;
+
+  if (round_up && !keep) {
+    out("1", 1U, buffer, idx++, maxlen);
+  }
+  else if (buf && round_up) {
+    buf[keep - 1U]++;
+  }
+  while (pos < len) {
+    if (pos == point) {
+      out(".", 1U, buffer, idx++, maxlen);
+    }
+    size_t n = (pos < point) ? point - pos : len - pos;
+    if (pos < keep) {
+      n = (n < keep - pos) ? n : keep - pos;
+      if (buf) {
+        out(buf + pos, n, buffer, idx, maxlen);
+      }
+      else {
+        n = (n < 9U) ? n : 9U;
+        _ftoa_read(dec, digits, n);
+        if (round_up && (pos + n == keep)) {
+          digits[n - 1U]++;
+        }
+        out(digits, n, buffer, idx, maxlen);
+      }
+      idx += n;
+    }
+    else {
+      idx = _out_fill(out, buffer, idx, maxlen, '0', n);
+    }
+    pos += n;
+  }
+  return idx;
+}
+
+
+// internal sign of a float
+static char _ftoa_sign(bool negative, unsigned int flags)
+{
+  if (negative) {
+    return '-';
+  }
+  if (flags & FLAGS_PLUS) {
+    return '+';  // ignore the space if the '+' exists
+  }
+  return (flags & FLAGS_SPACE) ? ' ' : 0;
+}
+
+
+// internal padding of a float of 'len' characters up to 'width', before the number
+// \return The count of leading zeros, the total length in 'total'
+static size_t _ftoa_pad(out_fct_type out, char* buffer, size_t* idx, size_t maxlen, char sign, size_t len, unsigned int width, unsigned int flags, size_t* total)
+{
+  size_t zeros = 0U;
+
+  // count leading zeros
+  if (!(flags & FLAGS_LEFT) && (flags & FLAGS_ZEROPAD)) {
+    if (width && sign) {
+      width--;
+    }
+    if (len < width) {
+      zeros = width - len;
+    }
+  }
+  *total = (sign ? 1U : 0U) + zeros + len;
+
+  // pad spaces up to given width
+  if ((out != _out_null) && !(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD) && (*total < width)) {
+    *idx = _out_fill(out, buffer, *idx, maxlen, ' ', width - *total);
+  }
+  return zeros;
+}
+
+
+// internal output of the special values nan and inf
+static size_t _ftoa_special(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int width, unsigned int flags)
+{
+  if (value < -DBL_MAX)
+    return _out_str(out, buffer, idx, maxlen, "-inf", 4, width, flags);
+  if (value > DBL_MAX)
+    return _out_str(out, buffer, idx, maxlen, (flags & FLAGS_PLUS) ? "+inf" : "inf", (flags & FLAGS_PLUS) ? 4U : 3U, width, flags);
+  return _out_str(out, buffer, idx, maxlen, "nan", 3, width, flags);
+}
+
+
+// internal fixed decimal output of 'dec', read from its first whole chunk,
+// 'buf' holds FTOA_DIGITS digits
+static size_t _ftoa_fixed(out_fct_type out, char* buffer, size_t idx, size_t maxlen, ftoa_dec_type* dec, char* buf, bool negative, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  // whole digits without the leading zeros of the top chunk
+  const size_t top   = _ntoa_len_long(dec->chunk[dec->chunks - 1U], 10U);
+  const size_t whole = (dec->chunks - 1U) * 9U + top;
+  char* const digits = (whole + prec <= FTOA_DIGITS) ? buf : NULL;
+  bool round_up;
+  _ftoa_read(dec, NULL, 9U - top);
+  const size_t keep = _ftoa_round(dec, digits, whole + prec, &round_up);
+  const size_t len  = whole + prec + (prec ? 1U : 0U) + ((round_up && !keep) ? 1U : 0U);
+
+  const char sign = _ftoa_sign(negative, flags);
+  size_t total;
+  const size_t zeros = _ftoa_pad(out, buffer, &idx, maxlen, sign, len, width, flags, &total);
+  if (out == _out_null) {
+    // measuring only, the number is not output
+    return idx + ((total < width) && ((flags & FLAGS_LEFT) || !(flags & FLAGS_ZEROPAD)) ? width : total);
+  }
+
+  // sign and leading zeros
+  if (sign) {
+    out(&sign, 1U, buffer, idx++, maxlen);
+  }
+  if (zeros) {
+    idx = _out_fill(out, buffer, idx, maxlen, '0', zeros);
+  }
+
+  // the digits, read again if they were too many
+  if (!digits) {
+    _ftoa_rewind(dec);
+    _ftoa_read(dec, NULL, 9U - top);
+  }
+  idx = _ftoa_out(out, buffer, idx, maxlen, dec, digits, whole + prec, whole, keep, round_up);
+
+  // append pad spaces up to given width
+  if ((flags & FLAGS_LEFT) && (total < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - total);
+  }
+
+  return idx;
+}
+
+
+#if defined(PRINTF_SUPPORT_EXPONENTIAL)
+// internal ftoa variant for exponential floating-point type, contributed by Martijn Jasperse <m.jasperse@gmail.com>
+// the digits and the decimal exponent of 'dec' are exact, read as for _ftoa_fixed()
+static size_t _etoa_exp(out_fct_type out, char* buffer, size_t idx, size_t maxlen, ftoa_dec_type* dec, char* buf, double value, bool negative, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  // determine the decimal exponent from the count of leading zeros
+  const size_t skip = (value > 0) ? _ftoa_skip(dec) : dec->chunks * 9U - 1U;
+  int expval = (int)(dec->chunks * 9U) - 1 - (int)skip;
+
+  // in "%g" mode, "prec" is the number of *significant figures* not decimals
+  if (flags & FLAGS_ADAPT_EXP) {
+    // do we want to fall-back to "%f" mode?
+    if ((value >= 1e-4) && (value < 1e6)) {
+      if ((int)prec > expval) {
+        prec = (unsigned)((int)prec - expval - 1);
+      }
+      else {
+        prec = 0;
+      }
+      // the same digits in fixed notation, read again from the start
+      _ftoa_rewind(dec);
+      return _ftoa_fixed(out, buffer, idx, maxlen, dec, buf, negative, prec, width, flags & ~FLAGS_ADAPT_EXP);
+    }
+    // we use one sigfig for the whole part
+    if ((prec > 0) && (flags & FLAGS_PRECISION)) {
+      --prec;
+    }
+  }
+
+  // round to the significant digits, 9.99 may become 10.0
+  if (!(value > 0)) {
+    _ftoa_read(dec, NULL, skip);
+  }
+  char* const digits = (prec < FTOA_DIGITS) ? buf : NULL;
+  bool round_up;
+  const size_t keep = _ftoa_round(dec, digits, prec + 1U, &round_up);
+  if (round_up && !keep) {
+    expval++;
+  }
+
+  // the exponent format is "%+03d" and largest value is "307"
+  const unsigned long exp10 = (unsigned long)((expval < 0) ? -expval : expval);
+  const size_t elen = (exp10 < 100U) ? 2U : 3U;
+  const size_t len  = 1U + (prec ? prec + 1U : 0U) + 2U + elen;
+
+  const char sign = _ftoa_sign(negative, flags);
+  size_t total;
+  const size_t zeros = _ftoa_pad(out, buffer, &idx, maxlen, sign, len, width, flags, &total);
+  if (out == _out_null) {
+    // measuring only, the number is not output
+    return idx + ((total < width) && ((flags & FLAGS_LEFT) || !(flags & FLAGS_ZEROPAD)) ? width : total);
+  }
+
+  // sign and leading zeros
+  if (sign) {
+    out(&sign, 1U, buffer, idx++, maxlen);
+  }
+  if (zeros) {
+    idx = _out_fill(out, buffer, idx, maxlen, '0', zeros);
+  }
+
+  // the digits, read again if they were too many: d.ddd or the carry 1.000
+  if (!digits) {
+    _ftoa_rewind(dec);
+    if (value > 0) {
+      (void)_ftoa_skip(dec);
+    }
+    else {
+      _ftoa_read(dec, NULL, skip);
+    }
+  }
+  if (round_up && !keep) {
+    idx = _ftoa_out(out, buffer, idx, maxlen, dec, digits, prec, 0U, 0U, true);
+  }
+  else {
+    idx = _ftoa_out(out, buffer, idx, maxlen, dec, digits, prec + 1U, 1U, keep, round_up);
+  }
+
+  // the exponent
+  char exponent[5];
+  exponent[0] = (flags & FLAGS_UPPERCASE) ? 'E' : 'e';
+  exponent[1] = (expval < 0) ? '-' : '+';
+  _ntoa_digits_long(exponent + 2U, elen, exp10, 10U, 0U);
+  out(exponent, 2U + elen, buffer, idx, maxlen);
+  idx += 2U + elen;
+
+  // append pad spaces up to given width
+  if ((flags & FLAGS_LEFT) && (total < width)) {
+    idx = _out_fill(out, buffer, idx, maxlen, ' ', width - total);
+  }
+
+  return idx;
+}
+#endif  // PRINTF_SUPPORT_EXPONENTIAL
+
+
+// internal conversion of the finite, positive 'value' in fixed or in exponential notation,
+// this is the only place where the exact digits are kept on the stack, "%g" reuses them
+static size_t _dtoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, bool negative, unsigned int prec, unsigned int width, unsigned int flags, bool exp_notation)
+{
+  ftoa_dec_type dec;
+  char          buf[FTOA_DIGITS];
+
+  // set default precision, if not set explicitly
+  if (!(flags & FLAGS_PRECISION)) {
+    prec = PRINTF_DEFAULT_FLOAT_PRECISION;
+  }
+
+  _ftoa_dec_init(&dec, value);
+#if defined(PRINTF_SUPPORT_EXPONENTIAL)
+  if (exp_notation) {
+    return _etoa_exp(out, buffer, idx, maxlen, &dec, buf, value, negative, prec, width, flags);
+  }
+#else
+  (void)exp_notation;
+#endif
+  return _ftoa_fixed(out, buffer, idx, maxlen, &dec, buf, negative, prec, width, flags);
+}
+
+
+// internal ftoa for fixed decimal floating point, exact for all values and precisions:
+// the value is split to its binary mantissa and exponent, the whole part is converted
+// by division of 32 bit limbs, the fraction by multiplication of a fixed point number
+static size_t _ftoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  // test for special values
+  if (!((value >= -DBL_MAX) && (value <= DBL_MAX))) {
+    return _ftoa_special(out, buffer, idx, maxlen, value, width, flags);
+  }
+
+  // test for negative
+  bool negative = false;
+  if (value < 0) {
+    negative = true;
+    value = 0 - value;
+  }
+
+#if defined(PRINTF_MAX_FLOAT)
+  // optional limit of the whole digits, larger values switch to exp notation
+  if (value > PRINTF_MAX_FLOAT) {
+#if defined(PRINTF_SUPPORT_EXPONENTIAL)
+    return _dtoa(out, buffer, idx, maxlen, value, negative, prec, width, flags, true);
+#else
+    return 0U;
+#endif
+  }
+#endif
+
+  return _dtoa(out, buffer, idx, maxlen, value, negative, prec, width, flags, false);
+}
+
+
+#if defined(PRINTF_SUPPORT_EXPONENTIAL)
+// internal ftoa for exponential floating point, see _etoa_exp()
+static size_t _etoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  // check for NaN and special values
+  if (!((value >= -DBL_MAX) && (value <= DBL_MAX))) {
+    return _ftoa_special(out, buffer, idx, maxlen, value, width, flags);
+  }
+
+  // determine the sign
+  const bool negative = value < 0;
+  if (negative) {
+    value = -value;
+  }
+
+  return _dtoa(out, buffer, idx, maxlen, value, negative, prec, width, flags, true);
+}
+#endif  // PRINTF_SUPPORT_EXPONENTIAL
+
+
+#if defined(PRINTF_SUPPORT_SHORTEST)
+// Shortest round-trip conversion after the Ryu algorithm by Ulf Adams
+// (https://github.com/ulfjack/ryu): the decimal interval of all values rounding
+// to the double is computed by multiplication with 125 bit powers of 5, then
+// digits are removed as long as the interval holds a shorter number.
+// The powers are composed of every 26th power and a small correction, which
+// keeps the tables below 1 KB.
+
+// 5^0 ... 5^25
+static const uint64_t _pow5[26] = {
+  0x0000000000000001ULL, 0x0000000000000005ULL, 0x0000000000000019ULL, 0x000000000000007DULL,
+  0x0000000000000271ULL, 0x0000000000000C35ULL, 0x0000000000003D09ULL, 0x000000000001312DULL,
+  0x000000000005F5E1ULL, 0x00000000001DCD65ULL, 0x00000000009502F9ULL, 0x0000000002E90EDDULL,
+  0x000000000E8D4A51ULL, 0x0000000048C27395ULL, 0x000000016BCC41E9ULL, 0x000000071AFD498DULL,
+  0x0000002386F26FC1ULL, 0x000000B1A2BC2EC5ULL, 0x000003782DACE9D9ULL, 0x00001158E460913DULL,
+  0x000056BC75E2D631ULL, 0x0001B1AE4D6E2EF5ULL, 0x000878678326EAC9ULL, 0x002A5A058FC295EDULL,
+  0x00D3C21BCECCEDA1ULL, 0x0422CA8B0A00A425ULL,
+};
+
+// 5^(26*i), normalized to 125 bits
+static const uint64_t _pow5_split[13][2] = {
+  { 0x0000000000000000ULL, 0x1000000000000000ULL },
+  { 0x0000000000000000ULL, 0x14ADF4B7320334B9ULL },
+  { 0x0E549208B31ADB10ULL, 0x1ABA4714957D300DULL },
+  { 0x6DC6AD264D8F0866ULL, 0x1145B7E285BF98F5ULL },
+  { 0xEB1DBD923D8596CAULL, 0x1652EFDC6018A1FCULL },
+  { 0xB4C1B80B22AE923CULL, 0x1CDA62055B2D9D83ULL },
+  { 0x5BB28B4E8F7E4C30ULL, 0x12A5568B9F52F416ULL },
+  { 0xF08AED437682D4FBULL, 0x1819651531F9E78FULL },
+  { 0xB4EE134AD99BF150ULL, 0x1F25C186A6F04C28ULL },
+  { 0x16499ECB70C25F03ULL, 0x1420EB449C8842E6ULL },
+  { 0x85A56EAD360865B0ULL, 0x1A03FDE214CAF085ULL },
+  { 0x093DB1D57999890BULL, 0x10CFEB353A97DAD8ULL },
+  { 0xCF38BB735E3F36ACULL, 0x15BAAF44FA52673EULL },
+};
+
+// 2^(125-1+bits(5^(26*i))) / 5^(26*i) + 1
+static const uint64_t _pow5_inv_split[13][2] = {
+  { 0x0000000000000001ULL, 0x2000000000000000ULL },
+  { 0x52A6C95FC0655034ULL, 0x18C240C4AECB13BBULL },
+  { 0x7CA8D50071DFC806ULL, 0x1327FC58DA0F6FF5ULL },
+  { 0x6520247D3556476EULL, 0x1DA48CE468E7C702ULL },
+  { 0x6139CDD76802E6E9ULL, 0x16EF5B40C2FC7779ULL },
+  { 0xF951A7FF43DE8C79ULL, 0x11BEBDF578B2F391ULL },
+  { 0x7BE8BEE8D6E957E8ULL, 0x1B758D848FAC54B0ULL },
+  { 0x8BD3F9E999A423EAULL, 0x153EDA614071A3B7ULL },
+  { 0x0848F973CB3EE3CEULL, 0x10701BD527B4978CULL },
+  { 0x153285EBB9EFBFA2ULL, 0x196FBB9BB44DB44DULL },
+  { 0xADEEE7F86C07B696ULL, 0x13AE3591F5B4D936ULL },
+  { 0x4D686A4EAF182222ULL, 0x1E74404F3DAADA91ULL },
+  { 0x98C0A106E09EBD9FULL, 0x17900EA4FDA7C257ULL },
+};
+
+// 2 bit corrections of the composed powers, 16 per word
+static const uint32_t _pow5_offsets[21] = {
+  0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x40000000U, 0x59695995U,
+  0x55545555U, 0x56555515U, 0x41150504U, 0x40555410U, 0x44555145U, 0x44504540U,
+  0x45555550U, 0x40004000U, 0x96440440U, 0x55565565U, 0x54454045U, 0x40154151U,
+  0x55559155U, 0x51405555U, 0x00000105U,
+};
+
+static const uint32_t _pow5_inv_offsets[19] = {
+  0x54544554U, 0x04055545U, 0x10041000U, 0x00400414U, 0x40010000U, 0x41155555U,
+  0x00000454U, 0x00010044U, 0x40000000U, 0x44000041U, 0x50454450U, 0x55550054U,
+  0x51655554U, 0x40004000U, 0x01000001U, 0x00010500U, 0x51515411U, 0x05555554U,
+  0x00000000U,
+};
+
+
+// internal bit count of 5^e, e > 0: ceil(log2(5^e))
+static inline unsigned int _pow5_bits(unsigned int e)
+{
+  return ((e * 1217359U) >> 19U) + 1U;
+}
+
+
+// internal floor(log10(2^e)) and floor(log10(5^e))
+static inline unsigned int _log10_pow2(unsigned int e)
+{
+  return (e * 78913U) >> 18U;
+}
+
+static inline unsigned int _log10_pow5(unsigned int e)
+{
+  return (e * 732923U) >> 20U;
+}
+
+
+// internal 64 x 64 bit multiplication
+// \return The low 64 bits of the product, the high bits in 'high'
+static inline uint64_t _umul128(uint64_t a, uint64_t b, uint64_t* high)
+{
+#if defined(__SIZEOF_INT128__)
+  __extension__ const unsigned __int128 product = (unsigned __int128)a * b;
+  *high = (uint64_t)(product >> 64U);
+  return (uint64_t)product;
+#else
+  const uint64_t lo = (uint64_t)(uint32_t)a * (uint32_t)b;
+  const uint64_t mid1 = (uint64_t)(uint32_t)(a >> 32U) * (uint32_t)b;
+  const uint64_t mid2 = (uint64_t)(uint32_t)a * (uint32_t)(b >> 32U);
+  const uint64_t hi = (uint64_t)(uint32_t)(a >> 32U) * (uint32_t)(b >> 32U);
+  const uint64_t cross = (lo >> 32U) + (uint32_t)mid1 + mid2;
+  *high = hi + (mid1 >> 32U) + (cross >> 32U);
+  return (cross << 32U) | (uint32_t)lo;
+#endif
+}
+
+
+// internal right shift of the 128 bit value 'high:low' by 0 < 'dist' < 64
+static inline uint64_t _shr128(uint64_t low, uint64_t high, unsigned int dist)
+{
+  return (high << (64U - dist)) | (low >> dist);
+}
+
+
+// internal 5^i in 125 bits, composed of the tables
+static void _pow5_split_get(unsigned int i, uint64_t* result)
+{
+  const unsigned int base = i / 26U;
+  const unsigned int offset = i - base * 26U;
+  const uint64_t* mul = _pow5_split[base];
+  if (!offset) {
+    result[0] = mul[0];
+    result[1] = mul[1];
+    return;
+  }
+  uint64_t high0, high1;
+  const uint64_t low0 = _umul128(_pow5[offset], mul[0], &high0);
+  const uint64_t low1 = _umul128(_pow5[offset], mul[1], &high1);
+  const uint64_t sum = high0 + low1;
+  high1 += (sum < high0) ? 1U : 0U;
+  const unsigned int delta = _pow5_bits(i) - _pow5_bits(base * 26U);
+  const uint64_t corr = (_pow5_offsets[i / 16U] >> ((i % 16U) << 1U)) & 3U;
+  result[0] = _shr128(low0, sum, delta) + corr;
+  result[1] = _shr128(sum, high1, delta) + ((result[0] < corr) ? 1U : 0U);
+}
+
+
+// internal 1 / 5^q in 125 bits, composed of the tables
+static void _pow5_inv_split_get(unsigned int q, uint64_t* result)
+{
+  const unsigned int base = (q + 25U) / 26U;
+  const unsigned int offset = base * 26U - q;
+  const uint64_t* mul = _pow5_inv_split[base];
+  if (!offset) {
+    result[0] = mul[0];
+    result[1] = mul[1];
+    return;
+  }
+  uint64_t high0, high1;
+  const uint64_t low0 = _umul128(_pow5[offset], mul[0] - 1U, &high0);
+  const uint64_t low1 = _umul128(_pow5[offset], mul[1], &high1);
+  const uint64_t sum = high0 + low1;
+  high1 += (sum < high0) ? 1U : 0U;
+  const unsigned int delta = _pow5_bits(base * 26U) - _pow5_bits(q);
+  const uint64_t corr = ((_pow5_inv_offsets[q / 16U] >> ((q % 16U) << 1U)) & 3U) + 1U;
+  result[0] = _shr128(low0, sum, delta) + corr;
+  result[1] = _shr128(sum, high1, delta) + ((result[0] < corr) ? 1U : 0U);
+}
+
+
+// internal (m * mul) >> j for the 125 bit 'mul' and 64 < j < 128
+static inline uint64_t _mul_shift64(uint64_t m, const uint64_t* mul, unsigned int j)
+{
+  uint64_t high0, high1;
+  (void)_umul128(m, mul[0], &high0);
+  const uint64_t low1 = _umul128(m, mul[1], &high1);
+  const uint64_t sum = high0 + low1;
+  high1 += (sum < high0) ? 1U : 0U;
+  return _shr128(sum, high1, j - 64U);
+}
+
+
+// internal test if 5^p divides 'value'
+static inline bool _multiple_of_pow5(uint64_t value, unsigned int p)
+{
+  unsigned int count = 0U;
+  while (value && !(value % 5U)) {
+    value /= 5U;
+    count++;
+  }
+  return count >= p;
+}
+
+
+// internal decimal conversion of a finite, positive double to the shortest
+// 'digits' * 10^'exp10' which reads back to the same double
+static uint64_t _shortest(uint64_t bits, int* exp10)
+{
+  const uint64_t mantissa = bits & ((1ULL << 52U) - 1U);
+  const unsigned int exponent = (unsigned int)(bits >> 52U) & 0x07FFU;
+
+  // the value is m2 * 2^e2, the interval bounds are at 4*m2 +/- 2 (-1 below powers of 2)
+  int e2;
+  uint64_t m2;
+  if (!exponent) {
+    e2 = 1 - 1023 - 52 - 2;
+    m2 = mantissa;
+  }
+  else {
+    e2 = (int)exponent - 1023 - 52 - 2;
+    m2 = (1ULL << 52U) | mantissa;
+  }
+  const bool even = !(m2 & 1U);
+  const uint64_t mv = 4U * m2;
+  const unsigned int mm_shift = (mantissa || (exponent <= 1U)) ? 1U : 0U;
+
+  // the decimal interval [vm, vp] and the value vr, scaled by 10^-e10
+  uint64_t vr, vp, vm;
+  uint64_t mul[2];
+  int e10;
+  bool vm_zeros = false;   // all removed digits of vm are 0
+  bool vr_zeros = false;   // all removed digits of vr are 0
+  if (e2 >= 0) {
+    const unsigned int q = _log10_pow2((unsigned int)e2) - ((e2 > 3) ? 1U : 0U);
+    const unsigned int i = q + 125U + _pow5_bits(q) - 1U - (unsigned int)e2;
+    e10 = (int)q;
+    _pow5_inv_split_get(q, mul);
+    vr = _mul_shift64(4U * m2, mul, i);
+    vp = _mul_shift64(4U * m2 + 2U, mul, i);
+    vm = _mul_shift64(4U * m2 - 1U - mm_shift, mul, i);
+    if (q <= 21U) {
+      // only one of mp, mv and mm can be a multiple of 5
+      if (!(mv % 5U)) {
+        vr_zeros = _multiple_of_pow5(mv, q);
+      }
+      else if (even) {
+        vm_zeros = _multiple_of_pow5(mv - 1U - mm_shift, q);
+      }
+      else {
+        vp -= _multiple_of_pow5(mv + 2U, q) ? 1U : 0U;
+      }
+    }
+  }
+  else {
+    const unsigned int q = _log10_pow5((unsigned int)-e2) - ((e2 < -1) ? 1U : 0U);
+    const unsigned int i = (unsigned int)-e2 - q;
+    const unsigned int j = q + 125U - _pow5_bits(i);
+    e10 = (int)q + e2;
+    _pow5_split_get(i, mul);
+    vr = _mul_shift64(4U * m2, mul, j);
+    vp = _mul_shift64(4U * m2 + 2U, mul, j);
+    vm = _mul_shift64(4U * m2 - 1U - mm_shift, mul, j);
+    if (q <= 1U) {
+      // mv has at least q trailing 0 bits, so vr is exact
+      vr_zeros = true;
+      if (even) {
+        vm_zeros = (mm_shift == 1U);
+      }
+      else {
+        --vp;
+      }
+    }
+    else if (q < 63U) {
+      vr_zeros = !(mv & ((1ULL << q) - 1U));
+    }
+  }
+
+  // remove the digits while the interval holds a shorter number
+  unsigned int removed = 0U;
+  uint64_t last = 0U;
+  uint64_t digits;
+  if (vm_zeros || vr_zeros) {
+    // rare: the bounds are exact or the value is a tie
+    while (vp / 10U > vm / 10U) {
+      vm_zeros &= (vm % 10U == 0U);
+      vr_zeros &= (last == 0U);
+      last = vr % 10U;
+      vr /= 10U;
+      vp /= 10U;
+      vm /= 10U;
+      removed++;
+    }
+    if (vm_zeros) {
+      while (vm % 10U == 0U) {
+        vr_zeros &= (last == 0U);
+        last = vr % 10U;
+        vr /= 10U;
+        vp /= 10U;
+        vm /= 10U;
+        removed++;
+      }
+    }
+    if (vr_zeros && (last == 5U) && !(vr & 1U)) {
+      // exactly halfway, round to even
+      last = 4U;
+    }
+    digits = vr + ((((vr == vm) && (!even || !vm_zeros)) || (last >= 5U)) ? 1U : 0U);
+  }
+  else {
+    // common case, two digits per step first
+    bool round_up = false;
+    if (vp / 100U > vm / 100U) {
+      round_up = (vr % 100U >= 50U);
+      vr /= 100U;
+      vp /= 100U;
+      vm /= 100U;
+      removed += 2U;
+    }
+    while (vp / 10U > vm / 10U) {
+      round_up = (vr % 10U >= 5U);
+      vr /= 10U;
+      vp /= 10U;
+      vm /= 10U;
+      removed++;
+    }
+    digits = vr + (((vr == vm) || round_up) ? 1U : 0U);
+  }
+
+  *exp10 = e10 + (int)removed;
+  return digits;
+}
+
+
+// internal shortest round-trip floating point, in %g style: fixed notation for
+// decimal exponents from -4 to 16, exponential notation otherwise
+static size_t _rtoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, double value, unsigned int width, unsigned int flags)
+{
+  char buf[32];   // at most 17 digits, the point and "e-324", or "0.0000" and 17 digits
+  size_t len;
+
+  // test for special values
+  if (!((value >= -DBL_MAX) && (value <= DBL_MAX))) {
+    return _ftoa(out, buffer, idx, maxlen, value, 0U, width, flags);
+  }
+
+  union {
+    uint64_t U;
+    double   F;
+  } conv;
+  conv.F = value;
+  const bool negative = (conv.U >> 63U) != 0U;   // keeps the sign of -0
+  conv.U &= ~(1ULL << 63U);
+
+  uint64_t digits = 0U;
+  int exp10 = 0;
+  size_t count = 1U;
+  if (conv.U) {
+    digits = _shortest(conv.U, &exp10);
+    count = _ntoa_len_long_long(digits, 10U);
+  }
+  // exponent of the first digit
+  const int expval = exp10 + (int)count - 1;
+
+  if ((expval < -4) || (expval > 16)) {
+    // exponential notation: d.ddde+xx
+    _ntoa_digits_long_long(buf + 1U, count, digits, 10U, 0U);
+    buf[0] = buf[1];
+    len = 1U;
+    if (count > 1U) {
+      buf[1] = '.';
+      len = count + 1U;
+    }
+    buf[len++] = (flags & FLAGS_UPPERCASE) ? 'E' : 'e';
+    buf[len++] = (expval < 0) ? '-' : '+';
+    const unsigned long e = (unsigned long)((expval < 0) ? -expval : expval);
+    const size_t elen = (e < 100U) ? 2U : 3U;
+    _ntoa_digits_long(buf + len, elen, e, 10U, 0U);
+    len += elen;
+  }
+  else if (exp10 >= 0) {
+    // integer: the digits and trailing zeros
+    _ntoa_digits_long_long(buf, count, digits, 10U, 0U);
+    memset(buf + count, '0', (size_t)exp10);
+    len = count + (size_t)exp10;
+  }
+  else if (expval >= 0) {
+    // the point within the digits
+    const size_t whole = (size_t)expval + 1U;
+    _ntoa_digits_long_long(buf + 1U, count, digits, 10U, 0U);
+    memmove(buf, buf + 1U, whole);
+    buf[whole] = '.';
+    len = count + 1U;
+  }
+  else {
+    // leading zeros after the point
+    const size_t zeros = (size_t)(-expval - 1);
+    buf[0] = '0';
+    buf[1] = '.';
+    memset(buf + 2U, '0', zeros);
+    _ntoa_digits_long_long(buf + 2U + zeros, count, digits, 10U, 0U);
+    len = count + 2U + zeros;
+  }
+
+  // sign
+  char   sign = 0;
+  size_t zeros = 0U;
+  if (negative) {
+    sign = '-';
+  }
+  else if (flags & FLAGS_PLUS) {
+    sign = '+';  // ignore the space if the '+' exists
+  }
+  else if (flags & FLAGS_SPACE) {
+    sign = ' ';
+  }
+
+  // count leading zeros
+  if (!(flags & FLAGS_LEFT) && (flags & FLAGS_ZEROPAD)) {
+    if (width && sign) {
+      width--;
+    }
+    if (len < width) {
+      zeros = width - len;
+    }
+  }
+
+  return _out_num(out, buffer, idx, maxlen, &sign, sign ? 1U : 0U, zeros, buf, len, width, flags);
+}
+#endif  // PRINTF_SUPPORT_SHORTEST
+#endif  // PRINTF_SUPPORT_FLOAT
+
+
+// internal vsnprintf, 'stop' stops converting once 'maxlen' characters are output
+// (with maxlen 0 at the first output character), the returned length is not complete then
+static int _vsnprintf_ex(out_fct_type out, char* buffer, const size_t maxlen, const char* format, va_list va, bool stop)
+{
+  unsigned int flags, width, precision, n;
+  size_t idx = 0U;
+
+  if (!buffer || ((out == _out_buffer) && !maxlen)) {
+    // nothing is stored, use the null output function to measure the length only
+    out = _out_null;
+  }
+
+  while (*format)
+  {
+    // truncated output, stop converting
+    if (stop && idx && (idx >= maxlen)) {
+      break;
+    }
+
+    // format specifier?  %[flags][width][.precision][length]
+    if (*format != '%') {
+      // no, output the whole literal run up to the next specifier
+      const size_t len = _strlit(format);
+      _out_ref(out, format, len, buffer, idx, maxlen);
+      format += len;
+      idx    += len;
+      continue;
+    }
+    else {
+      // yes, evaluate it
+      format++;
+    }
+
+    // evaluate flags
+    flags = 0U;
+    do {
+      switch (*format) {
+        case '0': flags |= FLAGS_ZEROPAD; format++; n = 1U; break;
+        case '-': flags |= FLAGS_LEFT;    format++; n = 1U; break;
+        case '+': flags |= FLAGS_PLUS;    format++; n = 1U; break;
+        case ' ': flags |= FLAGS_SPACE;   format++; n = 1U; break;
+        case '#': flags |= FLAGS_HASH;    format++; n = 1U; break;
+        default :                                   n = 0U; break;
+      }
+    } while (n);
+
+    // evaluate width field
+    width = 0U;
+    if (_is_digit(*format)) {
+      width = _atoi(&format);
+    }
+    else if (*format == '*') {
+      const int w = va_arg(va, int);
+      if (w < 0) {
+        flags |= FLAGS_LEFT;    // reverse padding
+        width = (unsigned int)-w;
+      }
+      else {
+        width = (unsigned int)w;
+      }
+      format++;
+    }
+
+    // evaluate precision field
+    precision = 0U;
+    if (*format == '.') {
+      flags |= FLAGS_PRECISION;
+      format++;
+      if (_is_digit(*format)) {
+        precision = _atoi(&format);
+      }
+      else if (*format == '*') {
+        const int prec = (int)va_arg(va, int);
+        precision = prec > 0 ? (unsigned int)prec : 0U;
+        format++;
+      }
+    }
+
+    // evaluate length field
+    switch (*format) {
+      case 'l' :
+        flags |= FLAGS_LONG;
+        format++;
+        if (*format == 'l') {
+          flags |= FLAGS_LONG_LONG;
+          format++;
+        }
+        break;
+      case 'h' :
+        flags |= FLAGS_SHORT;
+        format++;
+        if (*format == 'h') {
+          flags |= FLAGS_CHAR;
+          format++;
+        }
+        break;
+#if defined(PRINTF_SUPPORT_PTRDIFF_T)
+      case 't' :
+        flags |= (sizeof(ptrdiff_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
+        format++;
+        break;
+#endif
+      case 'j' :
+        flags |= (sizeof(intmax_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
+        format++;
+        break;
+      case 'z' :
+        flags |= (sizeof(size_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
+        format++;
+        break;
+      case 'w' :
+        // exact width types: w8, w16, w32, w64 and w128
+        format++;
+        n = _atoi(&format);
+        if (n == 8U) {
+          flags |= FLAGS_SHORT | FLAGS_CHAR;
+        }
+        else if (n == 16U) {
+          flags |= FLAGS_SHORT;
+        }
+        else if ((n == 32U) && (sizeof(int) < 4U)) {
+          flags |= FLAGS_LONG;
+        }
+        else if (n == 64U) {
+          flags |= (sizeof(long) == 8U ? FLAGS_LONG : FLAGS_LONG_LONG);
+        }
+#if defined(PRINTF_SUPPORT_INT128)
+        else if (n == 128U) {
+          flags |= FLAGS_INT128;
+        }
+#endif
+        break;
+      default :
+        break;
+    }
+
+    // evaluate specifier
+    switch (*format) {
+      case 'd' :
+      case 'i' :
+      case 'u' :
+      case 'x' :
+      case 'X' :
+      case 'o' :
+      case 'b' : {
+        // set the base
+        unsigned int base;
+        if (*format == 'x' || *format == 'X') {
+          base = 16U;
+        }
+        else if (*format == 'o') {
+          base =  8U;
+        }
+        else if (*format == 'b') {
+          base =  2U;
+        }
+        else {
+          base = 10U;
+          flags &= ~FLAGS_HASH;   // no hash for dec format
+        }
+        // uppercase
+        if (*format == 'X') {
+          flags |= FLAGS_UPPERCASE;
+        }
+
+        // no plus or space flag for u, x, X, o, b
+        if ((*format != 'i') && (*format != 'd')) {
+          flags &= ~(FLAGS_PLUS | FLAGS_SPACE);
+        }
+
+        // ignore '0' flag when precision is given
+        if (flags & FLAGS_PRECISION) {
+          flags &= ~FLAGS_ZEROPAD;
+        }
+
+        // convert the integer
+        if ((*format == 'i') || (*format == 'd')) {
+          // signed
+#if defined(PRINTF_SUPPORT_INT128)
+          if (flags & FLAGS_INT128) {
+            const int128_type value = va_arg(va, int128_type);
+            idx = _ntoa_int128(out, buffer, idx, maxlen, (value < 0 ? 0U - (uint128_type)value : (uint128_type)value), value < 0, base, precision, width, flags);
+          }
+          else
+#endif
+          if (flags & FLAGS_LONG_LONG) {
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+            const long long value = va_arg(va, long long);
+            idx = _ntoa_long_long(out, buffer, idx, maxlen, (value < 0 ? 0U - (unsigned long long)value : (unsigned long long)value), value < 0, base, precision, width, flags);
+#endif
+          }
+          else if (flags & FLAGS_LONG) {
+            const long value = va_arg(va, long);
+            idx = _ntoa_long(out, buffer, idx, maxlen, (value < 0 ? 0U - (unsigned long)value : (unsigned long)value), value < 0, base, precision, width, flags);
+          }
+          else {
+            const int value = (flags & FLAGS_CHAR) ? (char)va_arg(va, int) : (flags & FLAGS_SHORT) ? (short int)va_arg(va, int) : va_arg(va, int);
+            idx = _ntoa_long(out, buffer, idx, maxlen, (value < 0 ? 0U - (unsigned int)value : (unsigned int)value), value < 0, base, precision, width, flags);
+          }
+        }
+        else {
+          // unsigned
+#if defined(PRINTF_SUPPORT_INT128)
+          if (flags & FLAGS_INT128) {
+            idx = _ntoa_int128(out, buffer, idx, maxlen, va_arg(va, uint128_type), false, base, precision, width, flags);
+          }
+          else
+#endif
+          if (flags & FLAGS_LONG_LONG) {
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+            idx = _ntoa_long_long(out, buffer, idx, maxlen, va_arg(va, unsigned long long), false, base, precision, width, flags);
+#endif
+          }
+          else if (flags & FLAGS_LONG) {
+            idx = _ntoa_long(out, buffer, idx, maxlen, va_arg(va, unsigned long), false, base, precision, width, flags);
+          }
+          else {
+            const unsigned int value = (flags & FLAGS_CHAR) ? (unsigned char)va_arg(va, unsigned int) : (flags & FLAGS_SHORT) ? (unsigned short int)va_arg(va, unsigned int) : va_arg(va, unsigned int);
+            idx = _ntoa_long(out, buffer, idx, maxlen, value, false, base, precision, width, flags);
+          }
+        }
+        format++;
+        break;
+      }
+#if defined(PRINTF_SUPPORT_FLOAT)
+      case 'f' :
+      case 'F' :
+        if (*format == 'F') flags |= FLAGS_UPPERCASE;
+        idx = _ftoa(out, buffer, idx, maxlen, va_arg(va, double), precision, width, flags);
+        format++;
+        break;
+#if defined(PRINTF_SUPPORT_EXPONENTIAL)
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+        if ((*format == 'g')||(*format == 'G')) flags |= FLAGS_ADAPT_EXP;
+        if ((*format == 'E')||(*format == 'G')) flags |= FLAGS_UPPERCASE;
+        idx = _etoa(out, buffer, idx, maxlen, va_arg(va, double), precision, width, flags);
+        format++;
+        break;
+#endif  // PRINTF_SUPPORT_EXPONENTIAL
+#if defined(PRINTF_SUPPORT_SHORTEST)
+      case 'r':
+      case 'R':
+        if (*format == 'R') flags |= FLAGS_UPPERCASE;
+        idx = _rtoa(out, buffer, idx, maxlen, va_arg(va, double), width, flags);
+        format++;
+        break;
+#endif  // PRINTF_SUPPORT_SHORTEST
+#endif  // PRINTF_SUPPORT_FLOAT
+      case 'c' : {
+        const char c = (char)va_arg(va, int);
+        // pre padding
+        if (!(flags & FLAGS_LEFT) && (width > 1U)) {
+          idx = _out_fill(out, buffer, idx, maxlen, ' ', width - 1U);
+        }
+        // char output
+        out(&c, 1U, buffer, idx++, maxlen);
+        // post padding
+        if ((flags & FLAGS_LEFT) && (width > 1U)) {
+          idx = _out_fill(out, buffer, idx, maxlen, ' ', width - 1U);
+        }
+        format++;
+        break;
+      }
+
+      case 's' : {
+        const char* p = va_arg(va, char*);
+        unsigned int l = _strnlen_s(p, precision ? precision : (size_t)-1);
+        // pre padding
+        if (flags & FLAGS_PRECISION) {
+          l = (l < precision ? l : precision);
+        }
+        if (!(flags & FLAGS_LEFT) && (l < width)) {
+          idx = _out_fill(out, buffer, idx, maxlen, ' ', width - l);
+        }
+        // string output
+        _out_ref(out, p, l, buffer, idx, maxlen);
+        idx += l;
+        // post padding
+        if ((flags & FLAGS_LEFT) && (l < width)) {
+          idx = _out_fill(out, buffer, idx, maxlen, ' ', width - l);
+        }
+        format++;
+        break;
+      }
+
+      case 'p' : {
+        width = sizeof(void*) * 2U;
+        flags |= FLAGS_ZEROPAD | FLAGS_UPPERCASE;
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+        const bool is_ll = sizeof(uintptr_t) == sizeof(long long);
+        if (is_ll) {
+          idx = _ntoa_long_long(out, buffer, idx, maxlen, (uintptr_t)va_arg(va, void*), false, 16U, precision, width, flags);
+        }
+        else {
+#endif
+          idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned long)((uintptr_t)va_arg(va, void*)), false, 16U, precision, width, flags);
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+        }
+#endif
+        format++;
+        break;
+      }
+
+      case '%' :
+        _out_ref(out, "%", 1U, buffer, idx++, maxlen);
+        format++;
+        break;
+
+      default :
+        _out_ref(out, format, 1U, buffer, idx++, maxlen);
+        format++;
+        break;
+    }
+  }
+
+  // termination
+  out("", 1U, buffer, idx < maxlen ? idx : maxlen - 1U, maxlen);
+
+  // return written chars without terminating \0
+  return (int)idx;
+}
+
+
+// internal vsnprintf
+static inline int _vsnprintf(out_fct_type out, char* buffer, const size_t maxlen, const char* format, va_list va)
+{
+  return _vsnprintf_ex(out, buffer, maxlen, format, va, false);
+}
+
+
+#if defined(PRINTF_SUPPORT_DEFERRED) || defined(PRINTF_SUPPORT_BINARY)
+// argument classes of a format specifier
+#define ARG_NONE        0U
+#define ARG_INT         1U
+#define ARG_LONG        2U
+#define ARG_LONG_LONG   3U
+#define ARG_DOUBLE      4U
+#define ARG_STRING      5U
+#define ARG_POINTER     6U
+#define ARG_INT128      7U
+
+// size of a single format specifier rebuilt for rendering, which holds
+// '%', 5 flags, width, '.' precision, 'w' and its number (10 digits each),
+// the rest of the length field, the specifier and the terminating 0
+#define SPEC_BUFFER_SIZE  48U
+
+
+// arguments of a format specifier
+typedef struct {
+  unsigned int arg;         // argument class
+  bool         is_unsigned; // unsigned integer conversion (u, x, X, o, b)
+  unsigned int flags;       // FLAGS_ZEROPAD, FLAGS_LEFT, FLAGS_PLUS, FLAGS_SPACE, FLAGS_HASH
+  unsigned int width;       // width given in the format
+  bool         width_star;  // int argument for the width
+  bool         prec_star;   // int argument for the precision
+  bool         precision;   // precision is given
+  unsigned int prec;        // precision given in the format
+  const char*  length;      // start of the length field
+} spec_type;
+
+
+// internal scan of a format specifier for its arguments, following the parsing rules of _vsnprintf()
+// \param format Points behind the '%'
+// \return Pointer to the specifier character
+static const char* _scan_spec(const char* format, spec_type* spec)
+{
+  unsigned int flags = 0U;
+  spec->is_unsigned = false;
+  spec->flags      = 0U;
+  spec->width      = 0U;
+  spec->width_star = false;
+  spec->prec_star  = false;
+  spec->precision  = false;
+  spec->prec       = 0U;
+
+  // flags
+  bool more;
+  do {
+    switch (*format) {
+      case '0': spec->flags |= FLAGS_ZEROPAD; format++; more = true;  break;
+      case '-': spec->flags |= FLAGS_LEFT;    format++; more = true;  break;
+      case '+': spec->flags |= FLAGS_PLUS;    format++; more = true;  break;
+      case ' ': spec->flags |= FLAGS_SPACE;   format++; more = true;  break;
+      case '#': spec->flags |= FLAGS_HASH;    format++; more = true;  break;
+      default :                                         more = false; break;
+    }
+  } while (more);
+
+  // width field
+  if (_is_digit(*format)) {
+    spec->width = _atoi(&format);
+  }
+  else if (*format == '*') {
+    spec->width_star = true;
+    format++;
+  }
+
+  // precision field
+  if (*format == '.') {
+    spec->precision = true;
+    format++;
+    if (_is_digit(*format)) {
+      spec->prec = _atoi(&format);
+    }
+    else if (*format == '*') {
+      spec->prec_star = true;
+      format++;
+    }
+  }
+
+  // length field
+  spec->length = format;
+  switch (*format) {
+    case 'l' :
+      flags |= FLAGS_LONG;
+      format++;
+      if (*format == 'l') {
+        flags |= FLAGS_LONG_LONG;
+        format++;
+      }
+      break;
+    case 'h' :
+      format++;
+      if (*format == 'h') {
+        format++;
+      }
+      break;
+#if defined(PRINTF_SUPPORT_PTRDIFF_T)
+    case 't' :
+      flags |= (sizeof(ptrdiff_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
+      format++;
+      break;
+#endif
+    case 'j' :
+      flags |= (sizeof(intmax_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
+      format++;
+      break;
+    case 'z' :
+      flags |= (sizeof(size_t) == sizeof(long) ? FLAGS_LONG : FLAGS_LONG_LONG);
+      format++;
+      break;
+    case 'w' : {
+      format++;
+      const unsigned int n = _atoi(&format);
+      if ((n == 32U) && (sizeof(int) < 4U)) {
+        flags |= FLAGS_LONG;
+      }
+      else if (n == 64U) {
+        flags |= (sizeof(long) == 8U ? FLAGS_LONG : FLAGS_LONG_LONG);
+      }
+#if defined(PRINTF_SUPPORT_INT128)
+      else if (n == 128U) {
+        flags |= FLAGS_INT128;
+      }
+#endif
+      break;
+    }
+    default :
+      break;
+  }
+
+  // specifier
+  switch (*format) {
+    case 'u' :
+    case 'x' :
+    case 'X' :
+    case 'o' :
+    case 'b' :
+      spec->is_unsigned = true;
+      // fall through
+    case 'd' :
+    case 'i' :
+      if (flags & FLAGS_INT128) {
+        spec->arg = ARG_INT128;
+      }
+      else if (flags & FLAGS_LONG_LONG) {
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+        spec->arg = ARG_LONG_LONG;
+#else
+        spec->arg = ARG_NONE;
+#endif
+      }
+      else {
+        spec->arg = (flags & FLAGS_LONG) ? ARG_LONG : ARG_INT;
+      }
+      break;
+#if defined(PRINTF_SUPPORT_FLOAT)
+    case 'f' :
+    case 'F' :
+#if defined(PRINTF_SUPPORT_EXPONENTIAL)
+    case 'e' :
+    case 'E' :
+    case 'g' :
+    case 'G' :
+#endif
+#if defined(PRINTF_SUPPORT_SHORTEST)
+    case 'r' :
+    case 'R' :
+#endif
+      spec->arg = ARG_DOUBLE;
+      break;
+#endif
+    case 'c' :
+      spec->arg = ARG_INT;
+      break;
+    case 's' :
+      spec->arg = ARG_STRING;
+      break;
+    case 'p' :
+      spec->arg = ARG_POINTER;
+      break;
+    default :
+      spec->arg = ARG_NONE;
+      break;
+  }
+  return format;
+}
+
+
+// internal copy of 'size' bytes to the record, only measures if record is NULL
+static inline void _put_arg(char* record, size_t* len, const void* data, size_t size)
+{
+  if (record) {
+    memcpy(record + *len, data, size);
+  }
+  *len += size;
+}
+
+
+// internal LEB128 encoding of an unsigned value, 7 bits per byte
+static inline void _put_varint(char* record, size_t* len, uintmax_t value)
+{
+  do {
+    const char byte = (char)((value & 0x7FU) | (value > 0x7FU ? 0x80U : 0U));
+    _put_arg(record, len, &byte, 1U);
+    value >>= 7U;
+  } while (value);
+}
+
+
+// reader of a captured record
+typedef struct {
+  const char*  pos;         // next byte of the record
+  size_t       left;        // bytes left in the record
+  bool         overrun;     // a read went beyond the end of the record
+  bool         packed;      // packed representation of binprintf()
+  unsigned int long_size;   // sizeof(long) of the target which captured the record
+  unsigned int ptr_size;    // sizeof(void*) of the target which captured the record
+} record_type;
+
+
+// internal read of 'size' bytes of a record
+// \return The bytes, or (at least 16) zeros if the record is too short
+static const char* _get_bytes(record_type* rec, size_t size)
+{
+  static const char zeros[16] = { 0 };
+  if (size > rec->left) {
+    rec->overrun = true;
+    rec->left    = 0U;
+    return zeros;
+  }
+  const char* data = rec->pos;
+  rec->pos  += size;
+  rec->left -= size;
+  return data;
+}
+
+
+// internal read of a null-terminated string of a record
+// \return The string, or an empty string if the record is too short
+static const char* _get_string(record_type* rec)
+{
+  // find the terminator within the record only, a truncated string has none
+  const char* end = (const char*)memchr(rec->pos, 0, rec->left);
+  return end ? _get_bytes(rec, (size_t)(end - rec->pos) + 1U) : _get_bytes(rec, rec->left + 1U);
+}
+
+
+// internal LEB128 decoding of an unsigned value
+static inline uintmax_t _get_varint(record_type* rec)
+{
+  uintmax_t value = 0U;
+  unsigned int shift = 0U;
+  unsigned char byte;
+  do {
+    byte = (unsigned char)*_get_bytes(rec, 1U);
+    value |= (uintmax_t)(byte & 0x7FU) << shift;
+    shift += 7U;
+  } while ((byte & 0x80U) && (shift < sizeof(uintmax_t) * 8U));
+  return value;
+}
+
+
+// internal capture of an integer value: native size, or if packed LEB128 encoded,
+// zigzag encoded before if signed, so the value is independent of the type size
+static inline void _put_int(char* record, size_t* len, intmax_t value, size_t size, bool packed)
+{
+  if (packed) {
+    _put_varint(record, len, ((uintmax_t)value << 1U) ^ (value < 0 ? ~(uintmax_t)0U : 0U));
+  }
+  else if (size == sizeof(int)) {
+    const int v = (int)value;
+    _put_arg(record, len, &v, sizeof(v));
+  }
+  else if (size == sizeof(long)) {
+    const long v = (long)value;
+    _put_arg(record, len, &v, sizeof(v));
+  }
+  else {
+    _put_arg(record, len, &value, sizeof(value));
+  }
+}
+
+
+// internal load of an integer value of _put_int() or of an unsigned packed value
+// \return The bits of the value, sign extended if it is signed
+static inline uintmax_t _get_int(record_type* rec, size_t size, bool is_unsigned)
+{
+  intmax_t value;
+  if (rec->packed) {
+    const uintmax_t v = _get_varint(rec);
+    return is_unsigned ? v : (v >> 1U) ^ (0U - (v & 1U));
+  }
+  else if (size == sizeof(int)) {
+    int v;
+    memcpy(&v, _get_bytes(rec, sizeof(v)), sizeof(v));
+    value = v;
+  }
+  else if (size == sizeof(long)) {
+    long v;
+    memcpy(&v, _get_bytes(rec, sizeof(v)), sizeof(v));
+    value = v;
+  }
+  else {
+    memcpy(&value, _get_bytes(rec, sizeof(value)), sizeof(value));
+  }
+  return (uintmax_t)value;
+}
+
+
+// internal capture of the arguments of a format string: the raw value of
+// every argument in native representation, or packed into a compact portable
+// representation (LEB128 integers, zigzag encoded if signed, little endian doubles),
+// strings are copied
+// \param record The record to write, NULL to measure the record size only
+// \return The size of the record
+static size_t _capture_args(char* record, const char* format, va_list va, bool packed)
+{
+  size_t len = 0U;
+  spec_type spec;
+
+  while (*format) {
+    if (*format != '%') {
+      format += _strlit(format);
+      continue;
+    }
+    format = _scan_spec(format + 1, &spec);
+    unsigned int prec = spec.prec;
+    if (spec.width_star) {
+      _put_int(record, &len, va_arg(va, int), sizeof(int), packed);
+    }
+    if (spec.prec_star) {
+      const int p = va_arg(va, int);
+      _put_int(record, &len, p, sizeof(int), packed);
+      prec = p > 0 ? (unsigned int)p : 0U;
+    }
+    switch (spec.arg) {
+      case ARG_INT :
+        if (packed && spec.is_unsigned) {
+          _put_varint(record, &len, va_arg(va, unsigned int));
+        }
+        else {
+          _put_int(record, &len, va_arg(va, int), sizeof(int), packed);
+        }
+        break;
+      case ARG_LONG :
+        if (packed && spec.is_unsigned) {
+          _put_varint(record, &len, va_arg(va, unsigned long));
+        }
+        else {
+          _put_int(record, &len, va_arg(va, long), sizeof(long), packed);
+        }
+        break;
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+      case ARG_LONG_LONG :
+        if (packed && spec.is_unsigned) {
+          _put_varint(record, &len, va_arg(va, unsigned long long));
+        }
+        else {
+          _put_int(record, &len, va_arg(va, long long), sizeof(long long), packed);
+        }
+        break;
+#endif
+#if defined(PRINTF_SUPPORT_INT128)
+      case ARG_INT128 : {
+        const uint128_type value = va_arg(va, uint128_type);
+        if (packed) {
+          _put_varint(record, &len, (unsigned long long)value);
+          _put_varint(record, &len, (unsigned long long)(value >> 64U));
+        }
+        else {
+          _put_arg(record, &len, &value, sizeof(value));
+        }
+        break;
+      }
+#endif
+#if defined(PRINTF_SUPPORT_FLOAT)
+      case ARG_DOUBLE : {
+        const double value = va_arg(va, double);
+        if (packed) {
+          uint64_t bits;
+          char bytes[sizeof(bits)];
+          memcpy(&bits, &value, sizeof(bits));
+          for (size_t i = 0U; i < sizeof(bytes); i++) {
+            bytes[i] = (char)(bits >> (8U * i));
+          }
+          _put_arg(record, &len, bytes, sizeof(bytes));
+        }
+        else {
+          _put_arg(record, &len, &value, sizeof(value));
+        }
+        break;
+      }
+#endif
+      case ARG_STRING : {
+        // copy the string, but not more than the precision allows to be printed
+        const char* p = va_arg(va, char*);
+        const unsigned int l = _strnlen_s(p, prec ? prec : (size_t)-1);
+        _put_arg(record, &len, p, l);
+        _put_arg(record, &len, "", 1U);
+        break;
+      }
+      case ARG_POINTER : {
+        const void* value = va_arg(va, void*);
+        if (packed) {
+          _put_varint(record, &len, (uintptr_t)value);
+        }
+        else {
+          _put_arg(record, &len, &value, sizeof(value));
+        }
+        break;
+      }
+      default :
+        break;
+    }
+    if (*format) {
+      format++;
+    }
+  }
+  return len;
+}
+
+
+// internal conversion of a single specifier with its argument
+static size_t _render_arg(out_fct_type out, char* buffer, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = _vsnprintf(out, buffer, (size_t)-1, format, va);
+  va_end(va);
+  return (size_t)ret;
+}
+
+
+// internal rendering of the arguments of _capture_args() with the conversion of _vsnprintf()
+// \param rec The reader of the captured arguments, advanced behind them
+// \return The number of characters output
+static size_t _render_args(out_fct_type out, char* buffer, const char* format, record_type* rec)
+{
+  size_t idx = 0U;
+  spec_type spec;
+
+  while (*format) {
+    if (*format != '%') {
+      const size_t len = _strlit(format);
+      _out_ref(out, format, len, buffer, idx, (size_t)-1);
+      format += len;
+      idx    += len;
+      continue;
+    }
+
+    // rebuild the specifier with '*' replaced by the recorded value, every flag once
+    // and the numbers without leading zeros, so any specifier fits into the buffer
+    char   spec_format[SPEC_BUFFER_SIZE];
+    size_t n = 0U;
+    format = _scan_spec(format + 1, &spec);
+    if (!*format) {
+      break;
+    }
+    format++;
+    if (spec.width_star) {
+      const int w = (int)_get_int(rec, sizeof(int), false);
+      if (w < 0) {
+        // negative width is left justified
+        spec.flags |= FLAGS_LEFT;
+        spec.width  = 0U - (unsigned int)w;
+      }
+      else {
+        spec.width = (unsigned int)w;
+      }
+    }
+    if (spec.prec_star) {
+      // negative precision is none
+      const int p = (int)_get_int(rec, sizeof(int), false);
+      spec.prec = (p > 0) ? (unsigned int)p : 0U;
+    }
+
+    // values of a target with wider types are rendered as long long, pointers
+    // of a target with other pointer size like %p as hex number of its width
+    const char* length = NULL;
+    char        specifier = format[-1];
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+    if ((spec.arg == ARG_LONG) && (rec->long_size > sizeof(long))) {
+      spec.arg = ARG_LONG_LONG;
+      length   = "ll";
+    }
+    if ((spec.arg == ARG_POINTER) && (rec->ptr_size != sizeof(void*))) {
+      spec.arg         = ARG_LONG_LONG;
+      spec.is_unsigned = true;
+      spec.flags      |= FLAGS_ZEROPAD;
+      spec.width       = rec->ptr_size * 2U;
+      length           = "ll";
+      specifier        = 'X';
+    }
+#endif
+
+    spec_format[n++] = '%';
+    for (unsigned int i = 0U; i < 5U; i++) {
+      // FLAGS_ZEROPAD to FLAGS_HASH are the lowest bits
+      if (spec.flags & (1U << i)) {
+        spec_format[n++] = "0-+ #"[i];
+      }
+    }
+    if (spec.width) {
+      n += _render_arg(_out_buffer, spec_format + n, "%u", spec.width);
+    }
+    if (spec.precision) {
+      spec_format[n++] = '.';
+      n += _render_arg(_out_buffer, spec_format + n, "%u", spec.prec);
+    }
+    if (length) {
+      while (*length) {
+        spec_format[n++] = *length++;
+      }
+      spec_format[n++] = specifier;
+    }
+    else {
+      if (*spec.length == 'w') {
+        spec_format[n++] = *spec.length++;
+        n += _render_arg(_out_buffer, spec_format + n, "%u", _atoi(&spec.length));
+      }
+      // at most "ll" or "hh" and the specifier remain
+      while (spec.length < format) {
+        spec_format[n++] = *spec.length++;
+      }
+    }
+    spec_format[n] = 0;
+
+    switch (spec.arg) {
+      case ARG_INT :
+        idx += _render_arg(out, buffer, spec_format, (int)(unsigned int)_get_int(rec, sizeof(int), spec.is_unsigned));
+        break;
+      case ARG_LONG :
+        idx += _render_arg(out, buffer, spec_format, (long)(unsigned long)_get_int(rec, sizeof(long), spec.is_unsigned));
+        break;
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+      case ARG_LONG_LONG :
+        idx += _render_arg(out, buffer, spec_format, (long long)(unsigned long long)_get_int(rec, sizeof(long long), spec.is_unsigned));
+        break;
+#endif
+#if defined(PRINTF_SUPPORT_INT128)
+      case ARG_INT128 : {
+        uint128_type value;
+        if (rec->packed) {
+          value  = (uint128_type)_get_varint(rec);
+          value |= (uint128_type)_get_varint(rec) << 64U;
+        }
+        else {
+          memcpy(&value, _get_bytes(rec, sizeof(value)), sizeof(value));
+        }
+        idx += _render_arg(out, buffer, spec_format, value);
+        break;
+      }
+#endif
+#if defined(PRINTF_SUPPORT_FLOAT)
+      case ARG_DOUBLE : {
+        double value;
+        const char* bytes = _get_bytes(rec, sizeof(value));
+        if (rec->packed) {
+          uint64_t bits = 0U;
+          for (size_t i = 0U; i < sizeof(bits); i++) {
+            bits |= (uint64_t)(unsigned char)bytes[i] << (8U * i);
+          }
+          memcpy(&value, &bits, sizeof(value));
+        }
+        else {
+          memcpy(&value, bytes, sizeof(value));
+        }
+        idx += _render_arg(out, buffer, spec_format, value);
+        break;
+      }
+#endif
+      case ARG_STRING :
+        idx += _render_arg(out, buffer, spec_format, _get_string(rec));
+        break;
+      case ARG_POINTER : {
+        void* value;
+        if (rec->packed) {
+          value = (void*)(uintptr_t)_get_varint(rec);
+        }
+        else {
+          memcpy(&value, _get_bytes(rec, sizeof(value)), sizeof(value));
+        }
+        idx += _render_arg(out, buffer, spec_format, value);
+        break;
+      }
+      default :
+        idx += _render_arg(out, buffer, spec_format);
+        break;
+    }
+  }
+  return idx;
+}
+#endif  // PRINTF_SUPPORT_DEFERRED || PRINTF_SUPPORT_BINARY
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+int printf_(const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = vprintf_(format, va);
+  va_end(va);
+  return ret;
+}
+
+
+#if defined(PRINTF_SUPPORT_THREAD_BUFFER)
+void printf_thread_buffer(char* buffer, size_t size)
+{
+  printf_flush();
+  _thread_block.data = buffer;
+  _thread_block.size = size;
+  _thread_block.len  = 0U;
+  _thread_block.keep = true;
+}
+
+
+void printf_flush(void)
+{
+  if (_thread_block.data) {
+    _out_block_flush(&_thread_block, false);
+  }
+}
+#endif  // PRINTF_SUPPORT_THREAD_BUFFER
+
+
+int sprintf_(char* buffer, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = _vsnprintf(_out_buffer, buffer, (size_t)-1, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int snprintf_(char* buffer, size_t count, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = _vsnprintf(_out_buffer, buffer, count, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int vprintf_(const char* format, va_list va)
+{
+#if defined(PRINTF_SUPPORT_PUTBLOCK)
+#if defined(PRINTF_SUPPORT_THREAD_BUFFER)
+  if (_thread_block.data) {
+    const int ret = _vsnprintf(_out_block, (char*)&_thread_block, (size_t)-1, format, va);
+    // pass on the complete lines in one block
+    _out_block_flush(&_thread_block, true);
+    return ret;
+  }
+#endif
+  char stack[PRINTF_PUTBLOCK_BUFFER_SIZE];
+  out_block_type block = { stack, sizeof(stack), 0U, false };
+  const int ret = _vsnprintf(_out_block, (char*)&block, (size_t)-1, format, va);
+  // flush the rest
+  _out_block_flush(&block, false);
+  return ret;
+#else
+  char buffer[1];
+  return _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+#endif
+}
+
+
+int vsnprintf_(char* buffer, size_t count, const char* format, va_list va)
+{
+  return _vsnprintf(_out_buffer, buffer, count, format, va);
+}
+
+
+int snprintf_trunc(char* buffer, size_t count, bool* truncated, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = vsnprintf_trunc(buffer, count, truncated, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int vsnprintf_trunc(char* buffer, size_t count, bool* truncated, const char* format, va_list va)
+{
+  if (!buffer || !count) {
+    // no room for anything, truncated if there is any output
+    if (truncated) {
+      *truncated = (_vsnprintf_ex(_out_null, NULL, 0U, format, va, true) > 0);
+    }
+    return 0;
+  }
+  const size_t idx = (size_t)_vsnprintf_ex(_out_buffer, buffer, count, format, va, true);
+  if (truncated) {
+    *truncated = (idx >= count);
+  }
+  return (int)(idx < count ? idx : count - 1U);
+}
+
+
+int fctprintf(void (*out)(char character, void* arg), void* arg, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const out_fct_wrap_type out_fct_wrap = { out, arg };
+  const int ret = _vsnprintf(_out_fct, (char*)(uintptr_t)&out_fct_wrap, (size_t)-1, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int fctprintf_chunked(void (*out)(const char* data, size_t len, void* arg), void* arg, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = vfctprintf_chunked(out, arg, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int vfctprintf_chunked(void (*out)(const char* data, size_t len, void* arg), void* arg, const char* format, va_list va)
+{
+  const out_chunk_wrap_type out_chunk_wrap = { out, arg };
+  return _vsnprintf(_out_chunk, (char*)(uintptr_t)&out_chunk_wrap, (size_t)-1, format, va);
+}
+
+
+int iovprintf(struct printf_iovec* iov, size_t* iovcnt, char* scratch, size_t size, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = viovprintf(iov, iovcnt, scratch, size, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int viovprintf(struct printf_iovec* iov, size_t* iovcnt, char* scratch, size_t size, const char* format, va_list va)
+{
+  out_iov_type out_iov = { iov, 0U, *iovcnt, scratch, 0U, size, false };
+  const int ret = _vsnprintf(_out_iov, (char*)(uintptr_t)&out_iov, (size_t)-1, format, va);
+  *iovcnt = out_iov.iovcnt;
+  return ret;
+}
+
+
+#if defined(PRINTF_SUPPORT_DPRINTF)
+int dprintf_(int fd, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = vdprintf_(fd, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int vdprintf_(int fd, const char* format, va_list va)
+{
+  out_fd_type out_fd;
+  out_fd.fd    = fd;
+  out_fd.error = false;
+  out_fd.len   = 0U;
+  const int ret = _vsnprintf(_out_fd, (char*)&out_fd, (size_t)-1, format, va);
+  if (out_fd.len && !out_fd.error) {
+    // flush the rest
+    out_fd.error = !_write_fd(fd, out_fd.data, out_fd.len);
+  }
+  return out_fd.error ? -1 : ret;
+}
+#endif  // PRINTF_SUPPORT_DPRINTF
+
+
+#if defined(PRINTF_SUPPORT_ASPRINTF)
+int asprintf_(char** strp, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = vasprintf_(strp, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int vasprintf_(char** strp, const char* format, va_list va)
+{
+  out_alloc_type out_alloc;
+  out_alloc.data  = out_alloc.stack;
+  out_alloc.len   = 0U;
+  out_alloc.size  = sizeof(out_alloc.stack);
+  out_alloc.error = false;
+  // the output includes the terminating 0
+  const int ret = _vsnprintf(_out_alloc, (char*)&out_alloc, (size_t)-1, format, va);
+  if (!out_alloc.error && (out_alloc.data == out_alloc.stack)) {
+    // allocate the exact size for output which fits into the stack buffer
+    char* mem = (char*)_printf_realloc(NULL, out_alloc.len);
+    if (!mem) {
+      *strp = NULL;
+      return -1;
+    }
+    memcpy(mem, out_alloc.stack, out_alloc.len);
+    out_alloc.data = mem;
+  }
+  if (out_alloc.error) {
+    if (out_alloc.data != out_alloc.stack) {
+      _printf_free(out_alloc.data);
+    }
+    *strp = NULL;
+    return -1;
+  }
+  *strp = out_alloc.data;
+  return ret;
+}
+#endif  // PRINTF_SUPPORT_ASPRINTF
+
+
+void arena_printf_init(struct printf_arena* arena, char* buffer, size_t size, void* (*alloc)(size_t size), void (*release)(void* ptr))
+{
+  arena->data       = buffer;
+  arena->size       = size;
+  arena->used       = 0U;
+  arena->first      = buffer;
+  arena->block_size = size;
+  arena->blocks     = NULL;
+  arena->alloc      = alloc;
+  arena->release    = release;
+}
+
+
+void arena_printf_reset(struct printf_arena* arena)
+{
+  while (arena->blocks) {
+    void* block = arena->blocks;
+    memcpy(&arena->blocks, block, sizeof(void*));
+    arena->release(block);
+  }
+  arena->data = arena->first;
+  arena->size = arena->block_size;
+  arena->used = 0U;
+}
+
+
+struct printf_view arena_printf(struct printf_arena* arena, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const struct printf_view view = varena_printf(arena, format, va);
+  va_end(va);
+  return view;
+}
+
+
+struct printf_view varena_printf(struct printf_arena* arena, const char* format, va_list va)
+{
+  out_arena_type out_arena = { arena, arena->used, false };
+  struct printf_view view = { NULL, 0U };
+  // the output includes the terminating 0
+  const int ret = _vsnprintf(_out_arena, (char*)(uintptr_t)&out_arena, (size_t)-1, format, va);
+  if (out_arena.error) {
+    // drop the partial output
+    arena->used = out_arena.start;
+    return view;
+  }
+  view.ptr = arena->data + out_arena.start;
+  view.len = (size_t)ret;
+  return view;
+}
+
+
+#if defined(PRINTF_SUPPORT_RINGBUFFER)
+bool rbprintf_init(struct printf_ring* ring, char* buffer, size_t size)
+{
+  // positions are masked by size - 1, a ring of size 0 never has free space
+  const bool valid = size && !(size & (size - 1U));
+  ring->data = buffer;
+  ring->size = valid ? size : 0U;
+  ring->head = 0U;
+  ring->tail = 0U;
+  return valid;
+}
+
+
+int rbprintf(struct printf_ring* ring, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const int ret = vrbprintf(ring, format, va);
+  va_end(va);
+  return ret;
+}
+
 
-    // evaluate specifier
-    switch (*format) {
-      case 'd' :
-      case 'i' :
-      case 'u' :
-      case 'x' :
-      case 'X' :
-      case 'o' :
-      case 'b' : {
-        // set the base
-        unsigned int base;
-        if (*format == 'x' || *format == 'X') {
-          base = 16U;
-        }
-        else if (*format == 'o') {
-          base =  8U;
-        }
-        else if (*format == 'b') {
-          base =  2U;
-        }
-        else {
-          base = 10U;
-          flags &= ~FLAGS_HASH;   // no hash for dec format
-        }
-        // uppercase
-        if (*format == 'X') {
-          flags |= FLAGS_UPPERCASE;
-        }
+int vrbprintf(struct printf_ring* ring, const char* format, va_list va)
+{
+  // the consumer frees space by advancing tail, acquire it before overwriting that space
+  const size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  out_ring_type out_ring = { ring, ring->head, ring->size - (ring->head - tail), false };
+  const int ret = _vsnprintf(_out_ring, (char*)(uintptr_t)&out_ring, (size_t)-1, format, va);
+  if (out_ring.overflow) {
+    // drop the whole output, the consumer only sees complete calls
+    return -1;
+  }
+  __atomic_store_n(&ring->head, out_ring.head, __ATOMIC_RELEASE);
+  return ret;
+}
 
-        // no plus or space flag for u, x, X, o, b
-        if ((*format != 'i') && (*format != 'd')) {
-          flags &= ~(FLAGS_PLUS | FLAGS_SPACE);
-        }
 
-        // ignore '0' flag when precision is given
-        if (flags & FLAGS_PRECISION) {
-          flags &= ~FLAGS_ZEROPAD;
-        }
+size_t rbprintf_peek(struct printf_ring* ring, const char** data)
+{
+  const size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  const size_t pos  = ring->tail & (ring->size - 1U);
+  const size_t len  = head - ring->tail;
+  *data = ring->data + pos;
+  // return the contiguous part up to the end of the ring
+  return (len < ring->size - pos) ? len : ring->size - pos;
+}
 
-        // convert the integer
-        if ((*format == 'i') || (*format == 'd')) {
-          // signed
-          if (flags & FLAGS_LONG_LONG) {
-#if defined(PRINTF_SUPPORT_LONG_LONG)
-            const long long value = va_arg(va, long long);
-            idx = _ntoa_long_long(out, buffer, idx, maxlen, (unsigned long long)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
-#endif
-          }
-          else if (flags & FLAGS_LONG) {
-            const long value = va_arg(va, long);
-            idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned long)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
-          }
-          else {
-            const int value = (flags & FLAGS_CHAR) ? (char)va_arg(va, int) : (flags & FLAGS_SHORT) ? (short int)va_arg(va, int) : va_arg(va, int);
-            idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned int)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
-          }
-        }
-        else {
-          // unsigned
-          if (flags & FLAGS_LONG_LONG) {
-#if defined(PRINTF_SUPPORT_LONG_LONG)
-            idx = _ntoa_long_long(out, buffer, idx, maxlen, va_arg(va, unsigned long long), false, base, precision, width, flags);
-#endif
-          }
-          else if (flags & FLAGS_LONG) {
-            idx = _ntoa_long(out, buffer, idx, maxlen, va_arg(va, unsigned long), false, base, precision, width, flags);
-          }
-          else {
-            const unsigned int value = (flags & FLAGS_CHAR) ? (unsigned char)va_arg(va, unsigned int) : (flags & FLAGS_SHORT) ? (unsigned short int)va_arg(va, unsigned int) : va_arg(va, unsigned int);
-            idx = _ntoa_long(out, buffer, idx, maxlen, value, false, base, precision, width, flags);
-          }
-        }
-        format++;
-        break;
-      }
-#if defined(PRINTF_SUPPORT_FLOAT)
-      case 'f' :
-      case 'F' :
-        if (*format == 'F') flags |= FLAGS_UPPERCASE;
-        idx = _ftoa(out, buffer, idx, maxlen, va_arg(va, double), precision, width, flags);
-        format++;
-        break;
-#if defined(PRINTF_SUPPORT_EXPONENTIAL)
-      case 'e':
-      case 'E':
-      case 'g':
-      case 'G':
-        if ((*format == 'g')||(*format == 'G')) flags |= FLAGS_ADAPT_EXP;
-        if ((*format == 'E')||(*format == 'G')) flags |= FLAGS_UPPERCASE;
-        idx = _etoa(out, buffer, idx, maxlen, va_arg(va, double), precision, width, flags);
-        format++;
-        break;
-#endif  // PRINTF_SUPPORT_EXPONENTIAL
-#endif  // PRINTF_SUPPORT_FLOAT
-      case 'c' : {
-        unsigned int l = 1U;
-        // pre padding
-        if (!(flags & FLAGS_LEFT)) {
-          while (l++ < width) {
-            out(' ', buffer, idx++, maxlen);
-          }
-        }
-        // char output
-        out((char)va_arg(va, int), buffer, idx++, maxlen);
-        // post padding
-        if (flags & FLAGS_LEFT) {
-          while (l++ < width) {
-            out(' ', buffer, idx++, maxlen);
-          }
-        }
-        format++;
-        break;
-      }
 
-      case 's' : {
-        const char* p = va_arg(va, char*);
-        unsigned int l = _strnlen_s(p, precision ? precision : (size_t)-1);
-        // pre padding
-        if (flags & FLAGS_PRECISION) {
-          l = (l < precision ? l : precision);
-        }
-        if (!(flags & FLAGS_LEFT)) {
-          while (l++ < width) {
-            out(' ', buffer, idx++, maxlen);
-          }
-        }
-        // string output
-        while ((*p != 0) && (!(flags & FLAGS_PRECISION) || precision--)) {
-          out(*(p++), buffer, idx++, maxlen);
-        }
-        // post padding
-        if (flags & FLAGS_LEFT) {
-          while (l++ < width) {
-            out(' ', buffer, idx++, maxlen);
-          }
-        }
-        format++;
-        break;
-      }
+void rbprintf_consume(struct printf_ring* ring, size_t len)
+{
+  __atomic_store_n(&ring->tail, ring->tail + len, __ATOMIC_RELEASE);
+}
+#endif  // PRINTF_SUPPORT_RINGBUFFER
 
-      case 'p' : {
-        width = sizeof(void*) * 2U;
-        flags |= FLAGS_ZEROPAD | FLAGS_UPPERCASE;
-#if defined(PRINTF_SUPPORT_LONG_LONG)
-        const bool is_ll = sizeof(uintptr_t) == sizeof(long long);
-        if (is_ll) {
-          idx = _ntoa_long_long(out, buffer, idx, maxlen, (uintptr_t)va_arg(va, void*), false, 16U, precision, width, flags);
-        }
-        else {
-#endif
-          idx = _ntoa_long(out, buffer, idx, maxlen, (unsigned long)((uintptr_t)va_arg(va, void*)), false, 16U, precision, width, flags);
-#if defined(PRINTF_SUPPORT_LONG_LONG)
-        }
-#endif
-        format++;
-        break;
-      }
 
-      case '%' :
-        out('%', buffer, idx++, maxlen);
-        format++;
-        break;
+#if defined(PRINTF_SUPPORT_LOGBUFFER)
+// log buffer record header values, a record header holds its length + 1
+#define LOG_HEADER_FREE   ((size_t)0U)
+#define LOG_HEADER_SKIP   ((size_t)-1)
 
-      default :
-        out(*format, buffer, idx++, maxlen);
-        format++;
+// size of a log buffer record of 'len' characters, aligned to the header size
+static inline size_t _log_record_size(size_t len)
+{
+  return (sizeof(size_t) + len + 1U + sizeof(size_t) - 1U) & ~(sizeof(size_t) - 1U);
+}
+
+
+// internal release of 'record' bytes at the tail position 'pos' to the producers
+static void _log_release(struct printf_log* log, size_t pos, size_t record)
+{
+  // clear the space, free space must read as LOG_HEADER_FREE
+  memset(log->data + pos, 0, record);
+  __atomic_store_n(&log->tail, log->tail + record, __ATOMIC_RELEASE);
+}
+
+
+// internal reservation of a record of 'len' characters, which does not wrap across the end of the buffer
+// \return The record, or NULL if the buffer is too full
+static char* _log_reserve(struct printf_log* log, size_t len)
+{
+  const size_t record = _log_record_size(len);
+  size_t head = __atomic_load_n(&log->head, __ATOMIC_RELAXED);
+  size_t pos, skip;
+  for (;;) {
+    const size_t tail = __atomic_load_n(&log->tail, __ATOMIC_ACQUIRE);
+    pos  = head & (log->size - 1U);
+    skip = (pos + record > log->size) ? log->size - pos : 0U;
+    if (head + skip + record - tail <= log->size) {
+      if (__atomic_compare_exchange_n(&log->head, &head, head + skip + record, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
         break;
+      }
+      continue;
+    }
+    if (!skip || (head != tail) || (record > log->size)) {
+      return NULL;
     }
+    // empty, but the record only fits at the start of the buffer: skip the rest without a record,
+    // so the consumer realigns the tail and later records fit. Only the consumer moves the tail
+    if (__atomic_compare_exchange_n(&log->head, &head, head + skip, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      __atomic_store_n((size_t*)(void*)(log->data + pos), LOG_HEADER_SKIP, __ATOMIC_RELEASE);
+      return NULL;
+    }
+  }
+  if (skip) {
+    // let the consumer skip the rest at the end of the buffer
+    __atomic_store_n((size_t*)(void*)(log->data + pos), LOG_HEADER_SKIP, __ATOMIC_RELEASE);
+    pos = 0U;
   }
+  return log->data + pos + sizeof(size_t);
+}
 
-  // termination
-  out((char)0, buffer, idx < maxlen ? idx : maxlen - 1U, maxlen);
 
-  // return written chars without terminating \0
-  return (int)idx;
+// internal commit of a reserved record, makes it visible to the consumer
+static inline void _log_commit(char* record, size_t len)
+{
+  __atomic_store_n((size_t*)(void*)(record - sizeof(size_t)), len + 1U, __ATOMIC_RELEASE);
 }
 
 
-///////////////////////////////////////////////////////////////////////////////
+bool logprintf_init(struct printf_log* log, void* buffer, size_t size)
+{
+  // positions are masked by size - 1, an invalid size leaves an empty log buffer
+  // of size 0, its only header reads as LOG_HEADER_FREE and is never written
+  static size_t empty = LOG_HEADER_FREE;
+  const bool valid = (size >= sizeof(size_t)) && !(size & (size - 1U));
+  if (valid) {
+    // free space must read as LOG_HEADER_FREE
+    memset(buffer, 0, size);
+  }
+  log->data = valid ? (char*)buffer : (char*)&empty;
+  log->size = valid ? size : 0U;
+  log->head = 0U;
+  log->tail = 0U;
+  return valid;
+}
 
-int printf_(const char* format, ...)
+
+int logprintf(struct printf_log* log, const char* format, ...)
 {
   va_list va;
   va_start(va, format);
-  char buffer[1];
-  const int ret = _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+  const int ret = vlogprintf(log, format, va);
   va_end(va);
   return ret;
 }
 
 
-int sprintf_(char* buffer, const char* format, ...)
+int vlogprintf(struct printf_log* log, const char* format, va_list va)
 {
-  va_list va;
-  va_start(va, format);
-  const int ret = _vsnprintf(_out_buffer, buffer, (size_t)-1, format, va);
-  va_end(va);
+  // measure the output
+  va_list va_measure;
+  va_copy(va_measure, va);
+  const int ret = _vsnprintf(_out_null, NULL, 0U, format, va_measure);
+  va_end(va_measure);
+
+  // format into the reserved record and commit it
+  char* record = _log_reserve(log, (size_t)ret);
+  if (!record) {
+    return -1;
+  }
+  _vsnprintf(_out_buffer, record, (size_t)ret + 1U, format, va);
+  _log_commit(record, (size_t)ret);
   return ret;
 }
 
 
-int snprintf_(char* buffer, size_t count, const char* format, ...)
+const char* logprintf_read(struct printf_log* log, size_t* len)
+{
+  for (;;) {
+    const size_t pos    = log->tail & (log->size - 1U);
+    const size_t header = __atomic_load_n((size_t*)(void*)(log->data + pos), __ATOMIC_ACQUIRE);
+    if (header == LOG_HEADER_FREE) {
+      return NULL;  // next record is not committed yet
+    }
+    if (header != LOG_HEADER_SKIP) {
+      *len = header - 1U;
+      return log->data + pos + sizeof(size_t);
+    }
+    _log_release(log, pos, log->size - pos);
+  }
+}
+
+
+void logprintf_release(struct printf_log* log)
+{
+  const size_t pos    = log->tail & (log->size - 1U);
+  const size_t header = *(size_t*)(void*)(log->data + pos);
+  _log_release(log, pos, _log_record_size(header - 1U));
+}
+#endif  // PRINTF_SUPPORT_LOGBUFFER
+
+
+#if defined(PRINTF_SUPPORT_DEFERRED)
+int printf_deferred(struct printf_log* log, const char* format, ...)
 {
   va_list va;
   va_start(va, format);
-  const int ret = _vsnprintf(_out_buffer, buffer, count, format, va);
+  const int ret = vprintf_deferred(log, format, va);
   va_end(va);
   return ret;
 }
 
 
-int vprintf_(const char* format, va_list va)
+int vprintf_deferred(struct printf_log* log, const char* format, va_list va)
 {
-  char buffer[1];
-  return _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+  // measure the record
+  va_list va_measure;
+  va_copy(va_measure, va);
+  const size_t len = sizeof(format) + _capture_args(NULL, format, va_measure, false);
+  va_end(va_measure);
+
+  // capture the format pointer and the arguments into the reserved record and commit it
+  char* record = _log_reserve(log, len);
+  if (!record) {
+    return -1;
+  }
+  memcpy(record, &format, sizeof(format));
+  _capture_args(record + sizeof(format), format, va, false);
+  _log_commit(record, len);
+  return (int)len;
 }
 
 
-int vsnprintf_(char* buffer, size_t count, const char* format, va_list va)
+int printf_deferred_render(const char* record, void (*out)(const char* data, size_t len, void* arg), void* arg)
 {
-  return _vsnprintf(_out_buffer, buffer, count, format, va);
+  const out_chunk_wrap_type out_chunk_wrap = { out, arg };
+  const char* format;
+  memcpy(&format, record, sizeof(format));
+  record_type rec = { record + sizeof(format), (size_t)-1, false, false, sizeof(long), sizeof(void*) };
+  return (int)_render_args(_out_chunk, (char*)(uintptr_t)&out_chunk_wrap, format, &rec);
 }
+#endif  // PRINTF_SUPPORT_DEFERRED
 
 
-int fctprintf(void (*out)(char character, void* arg), void* arg, const char* format, ...)
+#if defined(PRINTF_SUPPORT_BINARY)
+// record header byte of binprintf(), log2 of sizeof(long) in bits 0-1 and of sizeof(void*) in bits 2-3
+#define BIN_SIZE_CODE(size)  ((size) == 8U ? 3U : (size) == 4U ? 2U : (size) == 2U ? 1U : 0U)
+#define BIN_HEADER           (char)(BIN_SIZE_CODE(sizeof(long)) | (BIN_SIZE_CODE(sizeof(void*)) << 2U))
+
+
+int binprintf(char* buffer, size_t size, const char* const* formats, unsigned int id, ...)
 {
   va_list va;
-  va_start(va, format);
-  const out_fct_wrap_type out_fct_wrap = { out, arg };
-  const int ret = _vsnprintf(_out_fct, (char*)(uintptr_t)&out_fct_wrap, (size_t)-1, format, va);
+  va_start(va, id);
+  const int ret = vbinprintf(buffer, size, formats, id, va);
   va_end(va);
   return ret;
 }
+
+
+int vbinprintf(char* buffer, size_t size, const char* const* formats, unsigned int id, va_list va)
+{
+  // measure the record
+  size_t len = 0U;
+  va_list va_measure;
+  va_copy(va_measure, va);
+  _put_varint(NULL, &len, id);
+  len += 1U + _capture_args(NULL, formats[id], va_measure, true);
+  va_end(va_measure);
+  if (len > size) {
+    return -1;
+  }
+
+  // write the id, the header and the packed arguments
+  size_t idx = 0U;
+  _put_varint(buffer, &idx, id);
+  buffer[idx++] = BIN_HEADER;
+  _capture_args(buffer + idx, formats[id], va, true);
+  return (int)len;
+}
+
+
+int binprintf_decode(const char* const* formats, size_t count, const char** data, size_t len, void (*out)(const char* data, size_t len, void* arg), void* arg)
+{
+  const out_chunk_wrap_type out_chunk_wrap = { out, arg };
+  record_type rec = { *data, len, false, true, 0U, 0U };
+  const uintmax_t id = _get_varint(&rec);
+  const unsigned char header = (unsigned char)*_get_bytes(&rec, 1U);
+  if (rec.overrun || (id >= count)) {
+    return -1;
+  }
+  rec.long_size = 1U << (header & 3U);
+  rec.ptr_size  = 1U << ((header >> 2U) & 3U);
+
+  // check that the record is complete before anything is output
+  record_type check = rec;
+  (void)_render_args(_out_null, NULL, formats[id], &check);
+  if (check.overrun) {
+    return -1;
+  }
+  const int ret = (int)_render_args(_out_chunk, (char*)(uintptr_t)&out_chunk_wrap, formats[id], &rec);
+  *data = rec.pos;
+  return ret;
+}
+#endif  // PRINTF_SUPPORT_BINARY
+
+
+#if defined(PRINTF_SUPPORT_LONG_LONG)
+// the public PRINTF_FLAGS_* are passed on as the internal FLAGS_*
+#if (PRINTF_FLAGS_ZEROPAD != FLAGS_ZEROPAD) || (PRINTF_FLAGS_LEFT != FLAGS_LEFT) || (PRINTF_FLAGS_PLUS != FLAGS_PLUS) || \
+    (PRINTF_FLAGS_SPACE != FLAGS_SPACE) || (PRINTF_FLAGS_HASH != FLAGS_HASH) || (PRINTF_FLAGS_UPPERCASE != FLAGS_UPPERCASE)
+#error "PRINTF_FLAGS_* must have the values of the internal FLAGS_*"
+#endif
+
+// internal formatting of an array of integers of 'size' bytes, the values are
+// converted directly, the format parsing of _vsnprintf() is not needed
+static int _format_array(char* dst, size_t cap, const void* vals, size_t n, size_t size, bool is_signed, unsigned int base, const char* sep, unsigned int flags)
+{
+  const out_fct_type out = (dst && cap) ? _out_buffer : _out_null;
+  const unsigned int width = flags >> 16U;
+  const size_t sep_len = sep ? strlen(sep) : 0U;
+  size_t idx = 0U;
+
+  // the public flags are the same as the internal ones, checked above
+  flags &= FLAGS_ZEROPAD | FLAGS_LEFT | FLAGS_PLUS | FLAGS_SPACE | FLAGS_HASH | FLAGS_UPPERCASE;
+  if (!is_signed) {
+    flags &= ~(FLAGS_PLUS | FLAGS_SPACE);
+  }
+  if (base == 10U) {
+    flags &= ~(FLAGS_HASH | FLAGS_UPPERCASE);
+  }
+
+  for (size_t i = 0U; i < n; i++) {
+    if (i && sep_len) {
+      _out_ref(out, sep, sep_len, dst, idx, cap);
+      idx += sep_len;
+    }
+    unsigned long long value;
+    bool negative = false;
+    if (size == sizeof(uint32_t)) {
+      value = ((const uint32_t*)vals)[i];
+    }
+    else if (is_signed) {
+      const int64_t v = ((const int64_t*)vals)[i];
+      negative = v < 0;
+      value = negative ? 0U - (unsigned long long)v : (unsigned long long)v;
+    }
+    else {
+      value = ((const uint64_t*)vals)[i];
+    }
+    idx = _ntoa_long_long(out, dst, idx, cap, value, negative, base, 0U, width, flags);
+  }
+
+  // termination
+  out("", 1U, dst, idx < cap ? idx : cap - 1U, cap);
+  return (int)idx;
+}
+
+
+int format_int_array(char* dst, size_t cap, const int64_t* vals, size_t n, const char* sep, unsigned int flags)
+{
+  return _format_array(dst, cap, vals, n, sizeof(*vals), true, 10U, sep, flags);
+}
+
+
+int format_uint_array(char* dst, size_t cap, const uint64_t* vals, size_t n, const char* sep, unsigned int flags)
+{
+  return _format_array(dst, cap, vals, n, sizeof(*vals), false, 10U, sep, flags);
+}
+
+
+int format_uint32_array(char* dst, size_t cap, const uint32_t* vals, size_t n, const char* sep, unsigned int flags)
+{
+  return _format_array(dst, cap, vals, n, sizeof(*vals), false, 10U, sep, flags);
+}
+
+
+int format_hex_array(char* dst, size_t cap, const uint64_t* vals, size_t n, const char* sep, unsigned int flags)
+{
+  return _format_array(dst, cap, vals, n, sizeof(*vals), false, 16U, sep, flags);
+}
+#endif  // PRINTF_SUPPORT_LONG_LONG
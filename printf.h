@@ -33,7 +33,17 @@
 #define _PRINTF_H_
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+
+// define this globally (e.g. gcc -DPRINTF_INCLUDE_CONFIG_H ...) to include the
+// printf_config.h header file, the configuration also selects the declared functions
+// default: undefined
+#ifdef PRINTF_INCLUDE_CONFIG_H
+#include "printf_config.h"
+#endif
 
 
 #ifdef __cplusplus
@@ -49,6 +59,17 @@ extern "C" {
 void _putchar(char character);
 
 
+/**
+ * Output a block of characters to a custom device like UART, used by the printf() function
+ * if PRINTF_PUTBLOCK_BUFFER_SIZE is defined > 0. Output is collected in a staging buffer of that
+ * size and passed on when the buffer is full, after each newline and at the end of the call.
+ * This function is declared here only. You have to write your custom implementation somewhere
+ * \param data Characters to output
+ * \param len Number of characters to output
+ */
+void _putblock(const char* data, size_t len);
+
+
 /**
  * Tiny printf implementation
  * You have to implement _putchar if you use printf()
@@ -88,6 +109,20 @@ int  snprintf_(char* buffer, size_t count, const char* format, ...);
 int vsnprintf_(char* buffer, size_t count, const char* format, va_list va);
 
 
+/**
+ * snprintf/vsnprintf variant that stops converting as soon as the buffer is full
+ * Unlike snprintf, the remaining arguments are not converted to count the characters that could have been written
+ * \param buffer A pointer to the buffer where to store the formatted string, NULL stores nothing like count 0
+ * \param count The maximum number of characters to store in the buffer, including a terminating null character
+ * \param truncated Is set to true if the output was truncated, may be NULL
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The number of characters that are WRITTEN into the buffer, not counting the terminating null character
+ */
+int  snprintf_trunc(char* buffer, size_t count, bool* truncated, const char* format, ...);
+int vsnprintf_trunc(char* buffer, size_t count, bool* truncated, const char* format, va_list va);
+
+
 /**
  * Tiny vprintf implementation
  * \param format A string that specifies the format of the output
@@ -98,6 +133,26 @@ int vsnprintf_(char* buffer, size_t count, const char* format, va_list va);
 int vprintf_(const char* format, va_list va);
 
 
+#if defined(PRINTF_ENABLE_SUPPORT_THREAD_BUFFER) && defined(PRINTF_PUTBLOCK_BUFFER_SIZE) && (PRINTF_PUTBLOCK_BUFFER_SIZE > 0)
+/**
+ * Set a line buffer for printf() and vprintf() of the calling thread, available if
+ * PRINTF_ENABLE_SUPPORT_THREAD_BUFFER is defined and PRINTF_PUTBLOCK_BUFFER_SIZE is defined > 0
+ * The output of the thread is collected in this buffer across calls, and only complete lines are
+ * passed to _putblock(), at the end of each call or when the buffer is full. So concurrent threads
+ * do not interleave within lines, and only _putblock() needs to be synchronized.
+ * \param buffer The line buffer, NULL to switch back to the per call staging buffer
+ * \param size Size of the line buffer
+ */
+void printf_thread_buffer(char* buffer, size_t size);
+
+
+/**
+ * Pass the pending (incomplete line) output of the thread buffer of the calling thread to _putblock()
+ */
+void printf_flush(void);
+#endif
+
+
 /**
  * printf with output function
  * You may use this as dynamic alternative to printf() with its fixed _putchar() output
@@ -109,6 +164,354 @@ int vprintf_(const char* format, va_list va);
 int fctprintf(void (*out)(char character, void* arg), void* arg, const char* format, ...);
 
 
+/**
+ * printf with chunked output function
+ * Like fctprintf(), but the output is passed on in contiguous runs of characters (literal text,
+ * string arguments, converted numbers, padding) instead of one call per character
+ * \param out An output function which takes a run of characters, its length and an argument pointer
+ * \param arg An argument pointer for user data passed to output function
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The number of characters that are sent to the output function, not counting the terminating null character
+ */
+int  fctprintf_chunked(void (*out)(const char* data, size_t len, void* arg), void* arg, const char* format, ...);
+int vfctprintf_chunked(void (*out)(const char* data, size_t len, void* arg), void* arg, const char* format, va_list va);
+
+
+/**
+ * printf to a POSIX file descriptor, available if PRINTF_DPRINTF_BUFFER_SIZE is defined > 0
+ * The output is collected in a staging buffer of that size and written with as few write() calls
+ * as possible, interrupted and short writes are continued
+ * \param fd The file descriptor to write to
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The number of characters that are written, not counting the terminating null character,
+ *         or -1 if a write error occurred (errno is set by write())
+ */
+#if defined(PRINTF_DPRINTF_BUFFER_SIZE) && (PRINTF_DPRINTF_BUFFER_SIZE > 0)
+#define dprintf  dprintf_
+#define vdprintf vdprintf_
+int  dprintf_(int fd, const char* format, ...);
+int vdprintf_(int fd, const char* format, va_list va);
+#endif
+
+
+#if defined(PRINTF_ASPRINTF_BUFFER_SIZE) && (PRINTF_ASPRINTF_BUFFER_SIZE > 0)
+/**
+ * Allocate or grow memory for asprintf(), like realloc()
+ * These functions are declared here only. You have to write your custom implementation somewhere
+ * if PRINTF_ASPRINTF_BUFFER_SIZE is defined > 0, e.g. by calling realloc() and free()
+ * \param ptr Memory to grow, NULL to allocate new memory
+ * \param size New size of the memory
+ * \return The (moved) memory, or NULL if out of memory (ptr is left untouched then)
+ */
+void* _printf_realloc(void* ptr, size_t size);
+void  _printf_free(void* ptr);
+
+
+/**
+ * printf to allocated memory, available if PRINTF_ASPRINTF_BUFFER_SIZE is defined > 0
+ * The output is formatted once into a stack buffer of that size, and spills into memory of _printf_realloc()
+ * when it does not fit. The returned string must be released with _printf_free().
+ * \param strp Is set to the allocated, null-terminated string, or NULL on error
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The number of characters that are written into the string, not counting the terminating null character,
+ *         or -1 if out of memory
+ */
+#define asprintf  asprintf_
+#define vasprintf vasprintf_
+int  asprintf_(char** strp, const char* format, ...);
+int vasprintf_(char** strp, const char* format, va_list va);
+#endif
+
+
+/**
+ * Output segment of iovprintf(), same layout as the POSIX 'struct iovec' used by writev()
+ */
+struct printf_iovec {
+  void*  iov_base;
+  size_t iov_len;
+};
+
+
+/**
+ * printf with scatter/gather output
+ * Instead of copying, the output is described by a list of segments which can be passed to writev().
+ * Literal text and string arguments are referenced in place, only converted numbers and characters
+ * are copied to the scratch space. Referenced strings must stay valid while the segments are used.
+ * If the segments or the scratch space run out, the output is truncated.
+ * \param iov Array of output segments
+ * \param iovcnt Number of available segments on input, number of used segments on return
+ * \param scratch Scratch space for converted values
+ * \param size Size of the scratch space
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The number of characters that COULD have been output, not counting the terminating null character.
+ *         A value larger than the sum of all segment lengths indicates truncation.
+ */
+int  iovprintf(struct printf_iovec* iov, size_t* iovcnt, char* scratch, size_t size, const char* format, ...);
+int viovprintf(struct printf_iovec* iov, size_t* iovcnt, char* scratch, size_t size, const char* format, va_list va);
+
+
+/**
+ * Bump allocator arena used by arena_printf()
+ * Output is appended to the current block, more blocks are allocated by 'alloc' when it is full
+ */
+struct printf_arena {
+  char*  data;                        // current block
+  size_t size;                        // size of the current block
+  size_t used;                        // used space of the current block
+  char*  first;                       // first block, provided by the caller
+  size_t block_size;                  // minimum size of allocated blocks
+  void*  blocks;                      // list of allocated blocks
+  void*  (*alloc)(size_t size);
+  void   (*release)(void* ptr);
+};
+
+
+/**
+ * Length-tagged string returned by arena_printf()
+ */
+struct printf_view {
+  const char* ptr;
+  size_t      len;
+};
+
+
+/**
+ * Initialize an arena for arena_printf()
+ * \param arena The arena to initialize
+ * \param buffer First block of the arena
+ * \param size Size of the first block, which is also the minimum size of allocated blocks
+ * \param alloc Allocation function for more blocks, NULL for an arena of the first block only
+ * \param release Release function for allocated blocks
+ */
+void arena_printf_init(struct printf_arena* arena, char* buffer, size_t size, void* (*alloc)(size_t size), void (*release)(void* ptr));
+
+
+/**
+ * Release all strings of an arena at once, allocated blocks are freed
+ * \param arena The arena to reset
+ */
+void arena_printf_reset(struct printf_arena* arena);
+
+
+/**
+ * printf to an arena
+ * The output is appended to the arena and stays valid until the arena is reset. If the current block
+ * is full, the output continues in a new block.
+ * \param arena The arena to output to
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The null-terminated output and its length, not counting the terminating null character.
+ *         ptr is NULL if the arena is full.
+ */
+struct printf_view  arena_printf(struct printf_arena* arena, const char* format, ...);
+struct printf_view varena_printf(struct printf_arena* arena, const char* format, va_list va);
+
+
+#if !defined(PRINTF_DISABLE_SUPPORT_RINGBUFFER) && defined(__GNUC__)
+/**
+ * Lock-free single producer/single consumer ring buffer used by rbprintf(), available with GCC/clang
+ * if PRINTF_DISABLE_SUPPORT_RINGBUFFER is not defined
+ * Positions are free running counters, only the producer writes 'head' and only the consumer writes 'tail'
+ */
+struct printf_ring {
+  char*  data;
+  size_t size;
+  size_t head;
+  size_t tail;
+};
+
+
+/**
+ * Initialize a ring buffer for rbprintf()
+ * \param ring The ring buffer to initialize
+ * \param buffer Storage of the ring buffer
+ * \param size Size of the storage, MUST be a power of 2
+ * \return false if size is not a power of 2, the ring stays empty and rbprintf() fails then
+ */
+bool rbprintf_init(struct printf_ring* ring, char* buffer, size_t size);
+
+
+/**
+ * printf to a lock-free single producer/single consumer ring buffer, for use by the producer
+ * The output wraps across the end of the ring and is made visible to the consumer when the call is complete.
+ * If it does not fit into the free space of the ring, nothing is output at all.
+ * \param ring The ring buffer to output to
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The number of characters that are written into the ring, or -1 if the ring is too full
+ */
+int  rbprintf(struct printf_ring* ring, const char* format, ...);
+int vrbprintf(struct printf_ring* ring, const char* format, va_list va);
+
+
+/**
+ * Get the next contiguous readable span of a ring buffer, for use by the consumer
+ * If the readable data wraps across the end of the ring, the first part is returned and
+ * the rest is returned by the next call after rbprintf_consume()
+ * \param ring The ring buffer to read from
+ * \param data Is set to the start of the readable span
+ * \return The length of the readable span, 0 if the ring is empty
+ */
+size_t rbprintf_peek(struct printf_ring* ring, const char** data);
+
+
+/**
+ * Release read data of a ring buffer to the producer, for use by the consumer
+ * \param ring The ring buffer
+ * \param len Number of characters to release, at most the length returned by rbprintf_peek()
+ */
+void rbprintf_consume(struct printf_ring* ring, size_t len);
+#endif
+
+
+#if !defined(PRINTF_DISABLE_SUPPORT_LOGBUFFER) && defined(__GNUC__)
+/**
+ * Lock-free multi producer/single consumer log buffer used by logprintf(), available with GCC/clang
+ * if PRINTF_DISABLE_SUPPORT_LOGBUFFER is not defined
+ * Positions are free running counters, producers reserve space by advancing 'head', the consumer advances 'tail'
+ */
+struct printf_log {
+  char*  data;
+  size_t size;
+  size_t head;
+  size_t tail;
+};
+
+
+/**
+ * Initialize a log buffer for logprintf()
+ * \param log The log buffer to initialize
+ * \param buffer Storage of the log buffer, MUST be aligned for size_t
+ * \param size Size of the storage, MUST be a power of 2 and at least sizeof(size_t)
+ * \return false if size is invalid, the log buffer stays empty and logprintf() fails then
+ */
+bool logprintf_init(struct printf_log* log, void* buffer, size_t size);
+
+
+/**
+ * printf to a lock-free multi producer/single consumer log buffer, for use by any number of producers
+ * The output length is measured first, then exactly that space is reserved atomically and the output
+ * is formatted directly into it. The record becomes visible to the consumer when it is committed at the end of the call.
+ * \param log The log buffer to output to
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The number of characters that are written into the record, or -1 if the log buffer is too full
+ */
+int  logprintf(struct printf_log* log, const char* format, ...);
+int vlogprintf(struct printf_log* log, const char* format, va_list va);
+
+
+/**
+ * Get the next committed record of a log buffer, for use by the consumer
+ * Records are returned in the order of their reservation, a record which is not committed yet
+ * holds back all records behind it
+ * \param log The log buffer to read from
+ * \param len Is set to the length of the record, not counting the terminating null character
+ * \return The null-terminated record, NULL if there is no committed record
+ */
+const char* logprintf_read(struct printf_log* log, size_t* len);
+
+
+/**
+ * Release the record returned by logprintf_read() to the producers, for use by the consumer
+ * \param log The log buffer
+ */
+void logprintf_release(struct printf_log* log);
+
+
+#if !defined(PRINTF_DISABLE_SUPPORT_DEFERRED)
+/**
+ * Deferred formatting: capture the raw arguments into a log buffer record now and render them later,
+ * e.g. on a background thread. Strings are copied, the format string itself is referenced and must
+ * stay valid until the record is rendered (e.g. a string literal)
+ * \param log The log buffer, initialized by logprintf_init()
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The number of bytes captured, -1 if the log buffer is full
+ */
+int printf_deferred(struct printf_log* log, const char* format, ...);
+int vprintf_deferred(struct printf_log* log, const char* format, va_list va);
+
+
+/**
+ * Render a record captured by printf_deferred(), for use by the consumer with logprintf_read()
+ * \param record The record returned by logprintf_read()
+ * \param out An output function which takes a chunk of characters and an argument pointer
+ * \param arg An argument pointer for user data passed to output function
+ * \return The number of characters that are sent to the output function
+ */
+int printf_deferred_render(const char* record, void (*out)(const char* data, size_t len, void* arg), void* arg);
+#endif
+#endif
+
+
+#if !defined(PRINTF_DISABLE_SUPPORT_BINARY)
+/**
+ * Binary log encoding: write the id of the format string, a header byte with the sizes of long and void*
+ * and the packed arguments (integers as LEB128, zigzag encoded if signed, doubles as 8 bytes little endian,
+ * strings copied with terminating 0) instead of text.
+ * The record is turned back into text by binprintf_decode(), e.g. by a host tool with the same format table
+ * \param buffer A pointer to the buffer where to store the record
+ * \param size The maximum number of bytes to store
+ * \param formats The format string table, shared with the decoder
+ * \param id The index of the format string in the table
+ * \param va A value identifying a variable arguments list
+ * \return The number of bytes written, -1 if the record does not fit into the buffer (nothing is written)
+ */
+int binprintf(char* buffer, size_t size, const char* const* formats, unsigned int id, ...);
+int vbinprintf(char* buffer, size_t size, const char* const* formats, unsigned int id, va_list va);
+
+
+/**
+ * Decode one complete record of binprintf() and output it as text with the normal conversion
+ * The values are converted with the type sizes of the encoding target, e.g. a 32 bit %lu value on a 64 bit host
+ * \param formats The format string table, the same as used by the encoder
+ * \param count The number of format strings in the table
+ * \param data Points to the record, advanced behind it
+ * \param len The number of bytes available at data
+ * \param out An output function which takes a chunk of characters and an argument pointer
+ * \param arg An argument pointer for user data passed to output function
+ * \return The number of characters that are sent to the output function, -1 on an unknown id or if the
+ *         record is longer than len (nothing is output and data is not advanced then)
+ */
+int binprintf_decode(const char* const* formats, size_t count, const char** data, size_t len, void (*out)(const char* data, size_t len, void* arg), void* arg);
+#endif
+
+
+// flags of the format_*_array() functions, same meaning as in a format specifier
+#define PRINTF_FLAGS_ZEROPAD    (1U << 0U)    // '0'
+#define PRINTF_FLAGS_LEFT       (1U << 1U)    // '-'
+#define PRINTF_FLAGS_PLUS       (1U << 2U)    // '+'
+#define PRINTF_FLAGS_SPACE      (1U << 3U)    // ' '
+#define PRINTF_FLAGS_HASH       (1U << 4U)    // '#', hex only
+#define PRINTF_FLAGS_UPPERCASE  (1U << 5U)    // 'X' instead of 'x', hex only
+#define PRINTF_FLAGS_WIDTH(w)   ((unsigned int)(w) << 16U)
+
+/**
+ * Format an array of integers, separated by a string, with one call
+ * The values are converted directly, like by "%lld", "%llu", "%u" or "%llx", without parsing a format string per value
+ * \param dst A pointer to the buffer where to store the formatted string
+ * \param cap The maximum number of characters to store in the buffer, including a terminating null character
+ * \param vals The values
+ * \param n The number of values
+ * \param sep The separator string between the values, may be NULL
+ * \param flags PRINTF_FLAGS_* and the field width by PRINTF_FLAGS_WIDTH()
+ * \return The number of characters that COULD have been written into the buffer, not counting the terminating
+ *         null character, like snprintf
+ * Available unless PRINTF_DISABLE_SUPPORT_LONG_LONG is defined
+ */
+#if !defined(PRINTF_DISABLE_SUPPORT_LONG_LONG)
+int format_int_array(char* dst, size_t cap, const int64_t* vals, size_t n, const char* sep, unsigned int flags);
+int format_uint_array(char* dst, size_t cap, const uint64_t* vals, size_t n, const char* sep, unsigned int flags);
+int format_uint32_array(char* dst, size_t cap, const uint32_t* vals, size_t n, const char* sep, unsigned int flags);
+int format_hex_array(char* dst, size_t cap, const uint64_t* vals, size_t n, const char* sep, unsigned int flags);
+#endif
+
+
 #ifdef __cplusplus
 }
 #endif
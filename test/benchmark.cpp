@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// \author (c) Marco Paland (info@paland.com)
+//             2017-2019, PALANDesign Hannover, Germany
+//
+// \license The MIT License (MIT)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// \brief printf integer conversion benchmark, build it native and with -m32
+//        to see the cost of 64 bit values on 32 bit targets
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+
+namespace test {
+  // use functions in own test namespace to avoid stdio conflicts
+  #include "../printf.h"
+  #include "../printf.c"
+} // namespace test
+
+
+// printf.h maps printf() to printf_(), the results go to stdio
+#undef printf
+
+
+void test::_putchar(char character)
+{
+  (void)character;
+}
+
+
+// xorshift pseudo random values, spread over all magnitudes by a variable shift
+static unsigned long long next_value(unsigned long long& state)
+{
+  state ^= state << 13U;
+  state ^= state >> 7U;
+  state ^= state << 17U;
+  return state >> (state % 64U);
+}
+
+
+template<typename T>
+static void run(const char* format)
+{
+  const unsigned int count = 5000000U;
+  char buffer[64];
+  unsigned long long state = 88172645463325252ULL;
+  size_t sum = 0U;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0U; i < count; ++i) {
+    sum += (size_t)test::snprintf_(buffer, sizeof(buffer), format, (T)next_value(state));
+  }
+  const auto stop = std::chrono::steady_clock::now();
+
+  const double ns = std::chrono::duration<double, std::nano>(stop - start).count() / count;
+  printf("%-8s %6.1f ns/call  (%u bit, %lu chars)\n", format, ns, (unsigned int)(sizeof(void*) * 8U), (unsigned long)sum);
+}
+
+
+int main()
+{
+  run<unsigned int>("%u");
+  run<int>("%d");
+  run<unsigned long long>("%llu");
+  run<long long>("%lld");
+  run<unsigned long long>("%llx");
+  run<unsigned long long>("%llo");
+  return 0;
+}
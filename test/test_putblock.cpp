@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+// \author (c) Marco Paland (info@paland.com)
+//             2017-2019, PALANDesign Hannover, Germany
+//
+// \license The MIT License (MIT)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// \brief printf unit tests of the buffered output through _putblock(), built
+//        as own binary, so test_suite.cpp covers the default _putchar() output
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// use the 'catch' test framework
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <string.h>
+
+
+// stage printf() output and pass it on in blocks through _putblock()
+#define PRINTF_PUTBLOCK_BUFFER_SIZE  16U
+#define PRINTF_ENABLE_SUPPORT_THREAD_BUFFER
+
+namespace test_putblock {
+  // use functions in own test namespace to avoid stdio conflicts
+  #include "../printf.h"
+  #include "../printf.c"
+} // namespace test_putblock
+
+
+// dummy putchar, not called if the output is staged
+static char   printf_buffer[100];
+static size_t printf_idx = 0U;
+static size_t putchar_calls = 0U;
+
+void test_putblock::_putchar(char character)
+{
+  putchar_calls++;
+  printf_buffer[printf_idx++] = character;
+}
+
+static size_t putblock_calls = 0U;
+
+void test_putblock::_putblock(const char* data, size_t len)
+{
+  putblock_calls++;
+  while (len--) {
+    printf_buffer[printf_idx++] = *data++;
+  }
+}
+
+
+TEST_CASE("putblock", "[]" ) {
+  printf_idx = 0U;
+  putblock_calls = 0U;
+  memset(printf_buffer, 0xCC, 100U);
+  REQUIRE(test_putblock::printf("%d", 42) == 2);
+  REQUIRE(putblock_calls == 1U);  // flushed at the end of the call
+  REQUIRE(!strncmp(printf_buffer, "42", 2U));
+
+  printf_idx = 0U;
+  putblock_calls = 0U;
+  REQUIRE(test_putblock::printf("Hello\nWorld %d\n", 42) == 15);
+  REQUIRE(putblock_calls == 2U);  // flushed after each newline
+  REQUIRE(!strncmp(printf_buffer, "Hello\nWorld 42\n", 15U));
+
+  printf_idx = 0U;
+  putblock_calls = 0U;
+  REQUIRE(test_putblock::printf("%c%s%c", 'a', "0123456789ABCDEF", 'b') == 18);
+  REQUIRE(putblock_calls == 2U);  // flushed when full
+  REQUIRE(!strncmp(printf_buffer, "a0123456789ABCDEFb", 18U));
+
+  printf_idx = 0U;
+  putblock_calls = 0U;
+  REQUIRE(test_putblock::printf("%40s", "x") == 40);
+  REQUIRE(putblock_calls == 2U);  // 32 pad spaces passed through, the rest staged
+  REQUIRE(printf_buffer[39] == 'x');
+  REQUIRE(printf_buffer[40] == (char)0xCC);
+  REQUIRE(putchar_calls == 0U);   // _putchar() is not used if the output is staged
+}
+
+
+TEST_CASE("printf_thread_buffer", "[]" ) {
+  char line[16];
+  test_putblock::printf_thread_buffer(line, sizeof(line));
+
+  printf_idx = 0U;
+  putblock_calls = 0U;
+  memset(printf_buffer, 0xCC, 100U);
+  REQUIRE(test_putblock::printf("%s", "abc") == 3);
+  REQUIRE(test_putblock::printf("%d", 42) == 2);
+  REQUIRE(putblock_calls == 0U);  // incomplete line is kept across calls
+  REQUIRE(test_putblock::printf("\n%d\n%d", 1, 2) == 4);
+  REQUIRE(putblock_calls == 1U);  // complete lines in one block
+  REQUIRE(!strncmp(printf_buffer, "abc42\n1\n", 8U));
+  REQUIRE(printf_buffer[8] == (char)0xCC);
+
+  // full buffer, complete lines are passed on first
+  REQUIRE(test_putblock::printf("345678901234\nabcdef") == 19);
+  REQUIRE(putblock_calls == 2U);
+  REQUIRE(!strncmp(printf_buffer + 8, "2345678901234\n", 14U));
+  test_putblock::printf_flush();
+  REQUIRE(putblock_calls == 3U);
+  REQUIRE(!strncmp(printf_buffer + 22, "abcdef", 6U));
+  REQUIRE(printf_buffer[30] == (char)0xCC);
+
+  test_putblock::printf_thread_buffer(nullptr, 0U);
+}
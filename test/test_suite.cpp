@@ -32,9 +32,21 @@
 
 #include <string.h>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 #include <math.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 
+// enable the file descriptor output with a small staging buffer
+#define PRINTF_DPRINTF_BUFFER_SIZE   16U
+
+// enable the allocating output with a small stack buffer
+#define PRINTF_ASPRINTF_BUFFER_SIZE  16U
+
 namespace test {
   // use functions in own test namespace to avoid stdio conflicts
   #include "../printf.h"
@@ -57,6 +69,30 @@ void _out_fct(char character, void* arg)
   printf_buffer[printf_idx++] = character;
 }
 
+static size_t chunk_calls = 0U;
+
+void _out_chunk(const char* data, size_t len, void* arg)
+{
+  (void)arg;
+  chunk_calls++;
+  while (len--) {
+    printf_buffer[printf_idx++] = *data++;
+  }
+}
+
+static size_t alloc_calls = 0U;
+static size_t alloc_limit = (size_t)-1;
+
+void* test::_printf_realloc(void* ptr, size_t size)
+{
+  return (++alloc_calls > alloc_limit) ? nullptr : realloc(ptr, size);
+}
+
+void test::_printf_free(void* ptr)
+{
+  free(ptr);
+}
+
 
 TEST_CASE("printf", "[]" ) {
   printf_idx = 0U;
@@ -77,6 +113,412 @@ TEST_CASE("fctprintf", "[]" ) {
 }
 
 
+TEST_CASE("fctprintf_chunked", "[]" ) {
+  printf_idx = 0U;
+  chunk_calls = 0U;
+  memset(printf_buffer, 0xCC, 100U);
+  REQUIRE(test::fctprintf_chunked(&_out_chunk, nullptr, "This is a test of %X and %-6s|", 0x12EFU, "chunks") == 34);
+  REQUIRE(!strncmp(printf_buffer, "This is a test of 12EF and chunks|", 34U));
+  REQUIRE(printf_buffer[34] == (char)0xCC);
+  REQUIRE(chunk_calls == 5U);
+
+  printf_idx = 0U;
+  chunk_calls = 0U;
+  test::fctprintf_chunked(&_out_chunk, nullptr, "%c", 0);
+  REQUIRE(chunk_calls == 0U);  // 0 characters are not sent, like fctprintf()
+}
+
+
+TEST_CASE("iovprintf", "[]" ) {
+  test::printf_iovec iov[8];
+  char scratch[8];
+  char buffer[100];
+  const char* format = "Hello %s, you are %d years%3s";
+  const char* name   = "world";
+  size_t iovcnt = 8U;
+
+  REQUIRE(test::iovprintf(iov, &iovcnt, scratch, sizeof(scratch), format, name, 42, "!") == 32);
+  REQUIRE(iovcnt == 7U);
+  REQUIRE(iov[0].iov_base == format);  // literal text is referenced
+  REQUIRE(iov[0].iov_len == 6U);
+  REQUIRE(iov[1].iov_base == name);    // string arguments are referenced
+  REQUIRE(iov[1].iov_len == 5U);
+  REQUIRE(iov[3].iov_base == scratch); // numbers are copied
+  REQUIRE(iov[3].iov_len == 2U);
+  size_t len = 0U;
+  for (size_t i = 0U; i < iovcnt; ++i) {
+    memcpy(buffer + len, iov[i].iov_base, iov[i].iov_len);
+    len += iov[i].iov_len;
+  }
+  buffer[len] = 0;
+  REQUIRE(!strcmp(buffer, "Hello world, you are 42 years  !"));
+
+  // consecutive copies are merged into one segment
+  iovcnt = 8U;
+  REQUIRE(test::iovprintf(iov, &iovcnt, scratch, sizeof(scratch), "%d%c%x", 12, 'a', 0xBC) == 5);
+  REQUIRE(iovcnt == 1U);
+  REQUIRE(!strncmp(scratch, "12abc", 5U));
+
+  // truncation, segments run out
+  iovcnt = 2U;
+  REQUIRE(test::iovprintf(iov, &iovcnt, scratch, sizeof(scratch), format, name, 42, "!") == 32);
+  REQUIRE(iovcnt == 2U);
+  REQUIRE(iov[0].iov_len + iov[1].iov_len == 11U);
+
+  // truncation, scratch space runs out
+  iovcnt = 8U;
+  REQUIRE(test::iovprintf(iov, &iovcnt, scratch, 4U, "%d-%d", 1234, 5678) == 9);
+  REQUIRE(iovcnt == 2U);
+  REQUIRE(iov[0].iov_base == scratch);
+  REQUIRE(iov[0].iov_len == 4U);
+  REQUIRE(iov[1].iov_len == 1U);
+}
+
+
+TEST_CASE("dprintf", "[]" ) {
+  char buffer[100];
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+
+  REQUIRE(test::dprintf(fds[1], "%d", 42) == 2);
+  REQUIRE(test::dprintf(fds[1], "|%s|%20d|", "This is a long string", -1) == 44);
+  REQUIRE(read(fds[0], buffer, sizeof(buffer)) == 46);
+  buffer[46] = 0;
+  REQUIRE(!strcmp(buffer, "42|This is a long string|                  -1|"));
+
+  close(fds[0]);
+  close(fds[1]);
+  REQUIRE(test::dprintf(fds[1], "%d", 42) == -1);
+}
+
+
+TEST_CASE("rbprintf", "[]" ) {
+  char storage[16];
+  char buffer[100];
+  const char* data;
+  test::printf_ring ring;
+
+  // the size must be a power of 2
+  REQUIRE(!test::rbprintf_init(&ring, storage, 12U));
+  REQUIRE(test::rbprintf(&ring, "%d", 1) == -1);
+  REQUIRE(test::rbprintf_peek(&ring, &data) == 0U);
+  REQUIRE(!test::rbprintf_init(&ring, storage, 0U));
+
+  REQUIRE(test::rbprintf_init(&ring, storage, sizeof(storage)));
+  REQUIRE(test::rbprintf_peek(&ring, &data) == 0U);
+  REQUIRE(test::rbprintf(&ring, "%s=%d;", "abc", 42) == 7);
+  REQUIRE(test::rbprintf(&ring, "%s=%d;", "de", -1) == 6);
+  REQUIRE(test::rbprintf_peek(&ring, &data) == 13U);
+  REQUIRE(!strncmp(data, "abc=42;de=-1;", 13U));
+  test::rbprintf_consume(&ring, 10U);
+
+  // wrap across the end of the ring
+  REQUIRE(test::rbprintf(&ring, "%08X", 0xBEEFU) == 8);
+  REQUIRE(test::rbprintf_peek(&ring, &data) == 6U);
+  memcpy(buffer, data, 6U);
+  test::rbprintf_consume(&ring, 6U);
+  REQUIRE(test::rbprintf_peek(&ring, &data) == 5U);
+  memcpy(buffer + 6U, data, 5U);
+  buffer[11] = 0;
+  REQUIRE(!strcmp(buffer, "-1;0000BEEF"));
+
+  // too full, nothing is output
+  REQUIRE(test::rbprintf(&ring, "%s", "This is too long") == -1);
+  REQUIRE(test::rbprintf_peek(&ring, &data) == 5U);
+  test::rbprintf_consume(&ring, 5U);
+  REQUIRE(test::rbprintf_peek(&ring, &data) == 0U);
+  REQUIRE(test::rbprintf(&ring, "%s", "This fits in 16.") == 16);
+}
+
+
+TEST_CASE("logprintf", "[]" ) {
+  size_t storage[64U / sizeof(size_t)];
+  const char* record;
+  size_t len;
+  test::printf_log log;
+
+  // the size must be a power of 2
+  REQUIRE(!test::logprintf_init(&log, storage, 48U));
+  REQUIRE(test::logprintf(&log, "%d", 1) == -1);
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+
+  REQUIRE(test::logprintf_init(&log, storage, sizeof(storage)));
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+  REQUIRE(test::logprintf(&log, "%s=%d", "abc", 42) == 6);
+  REQUIRE(test::logprintf(&log, "%s=%d", "de", -1) == 5);
+  record = test::logprintf_read(&log, &len);
+  REQUIRE(len == 6U);
+  REQUIRE(!strcmp(record, "abc=42"));
+  test::logprintf_release(&log);
+  record = test::logprintf_read(&log, &len);
+  REQUIRE(len == 5U);
+  REQUIRE(!strcmp(record, "de=-1"));
+
+  // too full, nothing is reserved
+  REQUIRE(test::logprintf(&log, "%48s", "x") == -1);
+  test::logprintf_release(&log);
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+
+  REQUIRE(test::logprintf(&log, "%d", 1) == 1);
+  REQUIRE(test::logprintf_read(&log, &len) != nullptr);
+  test::logprintf_release(&log);
+
+  // records do not wrap, the rest at the end of the buffer is skipped
+  REQUIRE(test::logprintf(&log, "%20s", "wrapped") == 20);
+  record = test::logprintf_read(&log, &len);
+  REQUIRE(len == 20U);
+  REQUIRE(!strcmp(record, "             wrapped"));
+  REQUIRE((void*)(record - sizeof(size_t)) == (void*)storage);
+  test::logprintf_release(&log);
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+
+  // empty, a record which fits into the buffer but not into the rest at the end is refused once,
+  // the rest is skipped and the record is reserved at the start when the consumer has realigned
+  REQUIRE(test::logprintf(&log, "%47s", "near capacity") == -1);
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+  REQUIRE(test::logprintf(&log, "%47s", "near capacity") == 47);
+  record = test::logprintf_read(&log, &len);
+  REQUIRE(len == 47U);
+  REQUIRE((void*)(record - sizeof(size_t)) == (void*)storage);
+  test::logprintf_release(&log);
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+  REQUIRE(test::logprintf(&log, "%d", 2) == 1);
+  record = test::logprintf_read(&log, &len);
+  REQUIRE(!strcmp(record, "2"));
+  test::logprintf_release(&log);
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+}
+
+
+TEST_CASE("logprintf threads", "[]" ) {
+  // one producer and one consumer on a small log buffer, records of all lengths wrap at every position
+  static const size_t count = 100000U;
+  const std::string pattern(45U, 'x');
+  size_t storage[64U / sizeof(size_t)];
+  test::printf_log log;
+  REQUIRE(test::logprintf_init(&log, storage, sizeof(storage)));
+
+  std::thread producer([&]() {
+    for (size_t i = 0U; i < count; ++i) {
+      while (test::logprintf(&log, "<%s>", pattern.c_str() + i % 46U) < 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  size_t bad = 0U;
+  for (size_t i = 0U; i < count; ) {
+    size_t len;
+    const char* record = test::logprintf_read(&log, &len);
+    if (!record) {
+      std::this_thread::yield();
+      continue;
+    }
+    const std::string expected = "<" + pattern.substr(i % 46U) + ">";
+    if ((len != expected.size()) || (expected != record)) {
+      bad++;
+    }
+    test::logprintf_release(&log);
+    i++;
+  }
+  producer.join();
+
+  REQUIRE(bad == 0U);
+  size_t len;
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+}
+
+
+TEST_CASE("printf_deferred", "[]" ) {
+  size_t storage[256U / sizeof(size_t)];
+  const char* record;
+  size_t len;
+  char str[32];
+  test::printf_log log;
+  test::logprintf_init(&log, storage, sizeof(storage));
+
+  strcpy(str, "abc");
+  REQUIRE(test::printf_deferred(&log, "%s=%d %5.2f|%-*s|%.*s|%lx%%", str, -42, 3.14159, 5, "ab", 2, "xyz", 0xABCDEFL) > 0);
+  REQUIRE(test::printf_deferred(&log, "%*d|%.3s|%c%c", -4, 7, "abcdef", 'o', 'k') > 0);
+  strcpy(str, "changed");  // strings are copied when captured
+
+  printf_idx = 0U;
+  memset(printf_buffer, 0xCC, 100U);
+  record = test::logprintf_read(&log, &len);
+  REQUIRE(test::printf_deferred_render(record, &_out_chunk, nullptr) == 30);
+  REQUIRE(!strncmp(printf_buffer, "abc=-42  3.14|ab   |xy|abcdef%", 30U));
+  REQUIRE(printf_buffer[30] == (char)0xCC);
+  test::logprintf_release(&log);
+
+  printf_idx = 0U;
+  record = test::logprintf_read(&log, &len);
+  REQUIRE(test::printf_deferred_render(record, &_out_chunk, nullptr) == 11);
+  REQUIRE(!strncmp(printf_buffer, "7   |abc|ok", 11U));
+  test::logprintf_release(&log);
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+
+  // specifiers longer than the rebuilt specifier, rendered like the original
+  char expected[100];
+  const char* long_format = "%-+-+-+-+-+-+-+-+-+-+ 0000012.000000000005lld|%*.*d|%w0000000032d|% +#0+#0*.*x";
+  REQUIRE(test::printf_deferred(&log, long_format, 42LL, -12, -1, 7, 5, -10, 3, 0xABU) > 0);
+  len = (size_t)test::snprintf(expected, sizeof(expected), long_format, 42LL, -12, -1, 7, 5, -10, 3, 0xABU);
+  REQUIRE(!strcmp(expected, "+42         |7           |5|0xab      "));
+  printf_idx = 0U;
+  record = test::logprintf_read(&log, &len);
+  REQUIRE(test::printf_deferred_render(record, &_out_chunk, nullptr) == 38);
+  REQUIRE(!strncmp(printf_buffer, expected, 38U));
+  test::logprintf_release(&log);
+
+  // too full, nothing is captured
+  REQUIRE(test::printf_deferred(&log, "%s", "This string does not fit into the log buffer, it is much too long for it "
+                                            "This string does not fit into the log buffer, it is much too long for it "
+                                            "This string does not fit into the log buffer, it is much too long for it "
+                                            "This string does not fit into the log buffer, it is much too long for it ") == -1);
+  REQUIRE(test::logprintf_read(&log, &len) == nullptr);
+}
+
+
+TEST_CASE("binprintf", "[]" ) {
+  static const char* const formats[] = {
+    "boot",
+    "%s=%d %5.2f|%-*s|%lx%%",
+    "%u %i %c %p",
+    "%lu %lx %ld %p"
+  };
+  char record[64];
+  const char* data = record;
+  int len;
+
+  len  = test::binprintf(record, sizeof(record), formats, 1U, "abc", -42, 3.14159, 5, "ab", 0xABCDEFL);
+  REQUIRE(len == 1 + 1 + 4 + 1 + 8 + 1 + 3 + 4);
+  len += test::binprintf(record + len, sizeof(record) - (size_t)len, formats, 0U);
+  REQUIRE(len == 25);
+  len += test::binprintf(record + len, sizeof(record) - (size_t)len, formats, 2U, 4294967295U, -1, 'x', (void*)0x1234U);
+  REQUIRE(len == 37);
+  REQUIRE(test::binprintf(record + len, sizeof(record) - (size_t)len, formats, 1U, "This string does not fit into the record buffer", 1, 1.0, 1, "", 1L) == -1);
+
+  printf_idx = 0U;
+  REQUIRE(test::binprintf_decode(formats, 4U, &data, (size_t)len, &_out_chunk, nullptr) == 27);
+  REQUIRE(!strncmp(printf_buffer, "abc=-42  3.14|ab   |abcdef%", 27U));
+  printf_idx = 0U;
+  REQUIRE(test::binprintf_decode(formats, 4U, &data, (size_t)(record + len - data), &_out_chunk, nullptr) == 4);
+  REQUIRE(!strncmp(printf_buffer, "boot", 4U));
+  printf_idx = 0U;
+  REQUIRE(test::binprintf_decode(formats, 4U, &data, (size_t)(record + len - data), &_out_chunk, nullptr) == (int)(16U + 2U * sizeof(void*)));
+  REQUIRE(!strncmp(printf_buffer, "4294967295 -1 x 0000", 20U));
+  REQUIRE(!strncmp(printf_buffer + 12U + 2U * sizeof(void*), "1234", 4U));
+  REQUIRE(data == record + len);
+
+  // unsigned values keep their value
+  len = test::binprintf(record, sizeof(record), formats, 3U, (unsigned long)-1, (unsigned long)-2, -3L, (void*)0x1234U);
+  data = record;
+  printf_idx = 0U;
+  REQUIRE(test::binprintf_decode(formats, 4U, &data, (size_t)len, &_out_chunk, nullptr) == (int)(sizeof(long) == 8U ? 41U : 23U) + (int)(2U * sizeof(void*)));
+  if (sizeof(long) == 8U) {
+    REQUIRE(!strncmp(printf_buffer, "18446744073709551615 fffffffffffffffe -3 ", 41U));
+  }
+  else {
+    REQUIRE(!strncmp(printf_buffer, "4294967295 fffffffe -3 ", 23U));
+  }
+
+  // record of a target with 32 bit long and pointers: id 3, header, %lu 0xFFFFFFFF,
+  // %lx 0xFFFFFFFE, %ld -3 (zigzag 5), %p 0x1234
+  const char narrow[] = { 3, 2 | (2 << 2), '\xFF', '\xFF', '\xFF', '\xFF', 0x0F, '\xFE', '\xFF', '\xFF', '\xFF', 0x0F, 5, '\xB4', 0x24 };
+  data = narrow;
+  printf_idx = 0U;
+  REQUIRE(test::binprintf_decode(formats, 4U, &data, sizeof(narrow), &_out_chunk, nullptr) == 31);
+  REQUIRE(!strncmp(printf_buffer, "4294967295 fffffffe -3 00001234", 31U));
+  REQUIRE(data == narrow + sizeof(narrow));
+
+  // truncated record, nothing is output
+  for (size_t i = 0U; i < sizeof(narrow); i++) {
+    data = narrow;
+    printf_idx = 0U;
+    REQUIRE(test::binprintf_decode(formats, 4U, &data, i, &_out_chunk, nullptr) == -1);
+    REQUIRE(data == narrow);
+    REQUIRE(printf_idx == 0U);
+  }
+  len = test::binprintf(record, sizeof(record), formats, 1U, "abc", -42, 3.14159, 5, "ab", 0xABCDEFL);
+  for (int i = 0; i < len; i++) {
+    // a heap copy of exactly the truncated length, so reading beyond it is caught by sanitizers
+    char* const copy = new char[(size_t)i];
+    memcpy(copy, record, (size_t)i);
+    data = copy;
+    REQUIRE(test::binprintf_decode(formats, 4U, &data, (size_t)i, &_out_chunk, nullptr) == -1);
+    REQUIRE(data == copy);
+    REQUIRE(printf_idx == 0U);
+    delete[] copy;
+  }
+
+  // unknown id
+  REQUIRE(test::binprintf(record, sizeof(record), formats, 0U) == 2);
+  data = record;
+  REQUIRE(test::binprintf_decode(formats, 0U, &data, 2U, &_out_chunk, nullptr) == -1);
+}
+
+
+TEST_CASE("asprintf", "[]" ) {
+  char* str;
+
+  alloc_calls = 0U;
+  REQUIRE(test::asprintf(&str, "%s=%d", "abc", 42) == 6);
+  REQUIRE(alloc_calls == 1U);  // fits into the stack buffer, exact allocation
+  REQUIRE(!strcmp(str, "abc=42"));
+  test::_printf_free(str);
+
+  alloc_calls = 0U;
+  REQUIRE(test::asprintf(&str, "%s %s %30d", "This is", "a long string", -1) == 52);
+  REQUIRE(alloc_calls == 2U);  // spilled and grown
+  REQUIRE(!strcmp(str, "This is a long string                             -1"));
+  test::_printf_free(str);
+
+  alloc_calls = 0U;
+  alloc_limit = 1U;
+  REQUIRE(test::asprintf(&str, "%s %s %30d", "This is", "a long string", -1) == -1);
+  REQUIRE(str == nullptr);
+  alloc_limit = (size_t)-1;
+}
+
+
+TEST_CASE("arena_printf", "[]" ) {
+  char storage[32];
+  test::printf_arena arena;
+  test::printf_view view;
+
+  // fixed arena
+  test::arena_printf_init(&arena, storage, sizeof(storage), nullptr, nullptr);
+  view = test::arena_printf(&arena, "%s=%d", "abc", 42);
+  REQUIRE(view.len == 6U);
+  REQUIRE(view.ptr == storage);
+  REQUIRE(!strcmp(view.ptr, "abc=42"));
+  view = test::arena_printf(&arena, "%s=%d", "de", -1);
+  REQUIRE(view.len == 5U);
+  REQUIRE(view.ptr == storage + 7);
+  REQUIRE(!strcmp(view.ptr, "de=-1"));
+  view = test::arena_printf(&arena, "%20s", "too long");
+  REQUIRE(view.ptr == nullptr);
+  REQUIRE(arena.used == 13U);
+  test::arena_printf_reset(&arena);
+  view = test::arena_printf(&arena, "%20s", "fits");
+  REQUIRE(view.ptr == storage);
+
+  // growing arena
+  test::arena_printf_init(&arena, storage, sizeof(storage), &malloc, &free);
+  view = test::arena_printf(&arena, "%s", "first");
+  REQUIRE(view.ptr == storage);
+  view = test::arena_printf(&arena, "%s %40s", "moved", "to a new block");
+  REQUIRE(view.len == 46U);
+  REQUIRE(view.ptr != storage);
+  REQUIRE(!strcmp(view.ptr, "moved                           to a new block"));
+  REQUIRE(!strcmp(storage, "first"));
+  view = test::arena_printf(&arena, "%d", 123);
+  REQUIRE(!strcmp(view.ptr, "123"));
+  test::arena_printf_reset(&arena);
+  REQUIRE(arena.blocks == nullptr);
+  REQUIRE(arena.data == storage);
+}
+
+
 TEST_CASE("snprintf", "[]" ) {
   char buffer[100];
 
@@ -700,6 +1142,50 @@ TEST_CASE("width 0-20", "[]" ) {
 }
 
 
+TEST_CASE("width 40", "[]" ) {
+  char buffer[100];
+
+  test::sprintf(buffer, "%40s", "Hello");
+  REQUIRE(!strcmp(buffer, "                                   Hello"));
+
+  test::sprintf(buffer, "%-40s|", "Hello");
+  REQUIRE(!strcmp(buffer, "Hello                                   |"));
+
+  test::sprintf(buffer, "%40c", 'x');
+  REQUIRE(!strcmp(buffer, "                                       x"));
+
+  test::sprintf(buffer, "%40d", -1024);
+  REQUIRE(!strcmp(buffer, "                                   -1024"));
+
+  test::sprintf(buffer, "%-40u|", 1024U);
+  REQUIRE(!strcmp(buffer, "1024                                    |"));
+
+  test::sprintf(buffer, "%040d", -1024);
+  REQUIRE(!strcmp(buffer, "-000000000000000000000000000000000001024"));
+
+  test::sprintf(buffer, "%.40d", 1024);
+  REQUIRE(!strcmp(buffer, "0000000000000000000000000000000000001024"));
+
+  test::sprintf(buffer, "%#040x", 0xBEEFU);
+  REQUIRE(!strcmp(buffer, "0x0000000000000000000000000000000000beef"));
+
+  test::sprintf(buffer, "%040.3f", -3.25);
+  REQUIRE(!strcmp(buffer, "-00000000000000000000000000000000003.250"));
+
+  test::snprintf(buffer, 10U, "%040d", 1);
+  REQUIRE(!strcmp(buffer, "000000000"));
+
+  test::snprintf(buffer, 10U, "%40d", 1);
+  REQUIRE(!strcmp(buffer, "         "));
+
+  printf_idx = 0U;
+  memset(printf_buffer, 0xCC, 100U);
+  test::fctprintf(&_out_fct, nullptr, "%040d|", -1024);
+  REQUIRE(!strncmp(printf_buffer, "-000000000000000000000000000000000001024|", 41U));
+  REQUIRE(printf_buffer[41] == (char)0xCC);
+}
+
+
 TEST_CASE("padding 20", "[]" ) {
   char buffer[100];
 
@@ -1120,15 +1606,12 @@ TEST_CASE("float", "[]" ) {
   test::sprintf(buffer, "%.10f", 42.895223);
   REQUIRE(!strcmp(buffer, "42.8952230000"));
 
-  // this testcase checks, that the precision is truncated to 9 digits.
-  // a perfect working float should return the whole number
+  // precision beyond 9 digits is exact
   test::sprintf(buffer, "%.12f", 42.89522312345678);
-  REQUIRE(!strcmp(buffer, "42.895223123000"));
+  REQUIRE(!strcmp(buffer, "42.895223123457"));
 
-  // this testcase checks, that the precision is truncated AND rounded to 9 digits.
-  // a perfect working float should return the whole number
   test::sprintf(buffer, "%.12f", 42.89522387654321);
-  REQUIRE(!strcmp(buffer, "42.895223877000"));
+  REQUIRE(!strcmp(buffer, "42.895223876543"));
 
   test::sprintf(buffer, "%6.2f", 42.8952);
   REQUIRE(!strcmp(buffer, " 42.90"));
@@ -1204,13 +1687,9 @@ TEST_CASE("float", "[]" ) {
   REQUIRE(!strcmp(buffer, "+1.230E+308"));
 #endif
 
-  // out of range for float: should switch to exp notation if supported, else empty
+  // large values print all whole digits
   test::sprintf(buffer, "%.1f", 1E20);
-#ifndef PRINTF_DISABLE_SUPPORT_EXPONENTIAL
-  REQUIRE(!strcmp(buffer, "1.0e+20"));
-#else
-  REQUIRE(!strcmp(buffer, ""));
-#endif
+  REQUIRE(!strcmp(buffer, "100000000000000000000.0"));
 
   // brute force float
   bool fail = false;
@@ -1225,9 +1704,7 @@ TEST_CASE("float", "[]" ) {
   REQUIRE(!fail);
 
 
-#ifndef PRINTF_DISABLE_SUPPORT_EXPONENTIAL
-  // brute force exp
-  str.setf(std::ios::scientific, std::ios::floatfield);
+  // brute force large values, all whole digits
   for (float i = -1e20; i < 1e20; i += 1e15) {
     test::sprintf(buffer, "%.5f", i);
     str.str("");
@@ -1235,10 +1712,163 @@ TEST_CASE("float", "[]" ) {
     fail = fail || !!strcmp(buffer, str.str().c_str());
   }
   REQUIRE(!fail);
+
+  // brute force exact digits over random bit patterns, up to 1074 fraction digits
+  char result[1500];
+  unsigned long long x = 88172645463325252ULL;
+  for (int i = 0; i < 20000; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    if (((x >> 52) & 0x7FFU) == 0x7FFU) {
+      continue;   // nan and inf
+    }
+    double value;
+    memcpy(&value, &x, sizeof(value));
+    const int prec = (int)(x % 1200U) % ((i % 4) ? 30 : 1100);
+    test::sprintf(result, "%.*f", prec, value);
+    str.str("");
+    str.precision(prec);
+    str << std::fixed << value;
+    fail = fail || !!strcmp(result, str.str().c_str());
+  }
+  REQUIRE(!fail);
+
+#ifndef PRINTF_DISABLE_SUPPORT_EXPONENTIAL
+  // brute force exact digits in exp notation over random bit patterns, up to 767 significant digits
+  for (int i = 0; i < 20000; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    if (((x >> 52) & 0x7FFU) == 0x7FFU) {
+      continue;   // nan and inf
+    }
+    double value;
+    memcpy(&value, &x, sizeof(value));
+    const int prec = (int)(x % 1200U) % ((i % 4) ? 30 : 800);
+    test::sprintf(result, "%.*e", prec, value);
+    str.str("");
+    str.precision(prec);
+    str << std::scientific << value;
+    fail = fail || !!strcmp(result, str.str().c_str());
+  }
+  REQUIRE(!fail);
 #endif
 }
 
 
+#ifndef PRINTF_DISABLE_SUPPORT_SHORTEST
+// true if a decimal with one significant digit less than 'str' reads back to 'value', so 'str' is not the shortest
+static bool shorter_round_trips(const char* str, double value)
+{
+  std::string digits;
+  int exp10 = 0;
+  bool point = false;
+  for (const char* p = str; *p && (*p != 'e') && (*p != 'E'); p++) {
+    if (*p == '.') {
+      point = true;
+    }
+    else if ((*p >= '0') && (*p <= '9')) {
+      digits += *p;
+      exp10 -= point ? 1 : 0;
+    }
+  }
+  const char* e = strpbrk(str, "eE");
+  exp10 += e ? atoi(e + 1) : 0;
+
+  // significant digits only
+  digits.erase(0U, digits.find_first_not_of('0'));
+  while (!digits.empty() && (digits.back() == '0')) {
+    digits.pop_back();
+    exp10++;
+  }
+  if (digits.size() <= 1U) {
+    return false;
+  }
+
+  // the neighbours with one digit less, below and above
+  const unsigned long long below = std::stoull(digits.substr(0U, digits.size() - 1U));
+  for (unsigned long long d = below; d <= below + 1U; d++) {
+    const std::string shorter = std::to_string(d) + "e" + std::to_string(exp10 + 1);
+    if (strtod(shorter.c_str(), nullptr) == fabs(value)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+TEST_CASE("shortest round-trip", "[]" ) {
+  char buffer[100];
+
+  test::sprintf(buffer, "%r", 0.1);
+  REQUIRE(!strcmp(buffer, "0.1"));
+
+  test::sprintf(buffer, "%r", 1.0 / 3.0);
+  REQUIRE(!strcmp(buffer, "0.3333333333333333"));
+
+  test::sprintf(buffer, "%r %r %r", 0.0, -0.0, 100.0);
+  REQUIRE(!strcmp(buffer, "0 -0 100"));
+
+  test::sprintf(buffer, "%r", 123.456);
+  REQUIRE(!strcmp(buffer, "123.456"));
+
+  test::sprintf(buffer, "%r %r", 0.0001, 0.000015);
+  REQUIRE(!strcmp(buffer, "0.0001 1.5e-05"));
+
+  test::sprintf(buffer, "%r %r", 1e16, 1e17);
+  REQUIRE(!strcmp(buffer, "10000000000000000 1e+17"));
+
+  test::sprintf(buffer, "%r", 1.7976931348623157e308);
+  REQUIRE(!strcmp(buffer, "1.7976931348623157e+308"));
+
+  test::sprintf(buffer, "%R", 5e-324);
+  REQUIRE(!strcmp(buffer, "5E-324"));
+
+  test::sprintf(buffer, "%r", 9007199254740993.0);
+  REQUIRE(!strcmp(buffer, "9007199254740992"));
+
+  test::sprintf(buffer, "[%10r][%-10r][%010r][%+r][% r]", 3.5, 3.5, -3.5, 3.5, 3.5);
+  REQUIRE(!strcmp(buffer, "[       3.5][3.5       ][-0000003.5][+3.5][ 3.5]"));
+
+  test::sprintf(buffer, "%r %r %5r", INFINITY, -INFINITY, NAN);
+  REQUIRE(!strcmp(buffer, "inf -inf   nan"));
+
+  REQUIRE(test::snprintf(nullptr, 0, "%r", 2.5e-300) == 8);
+
+  // hard cases of the shortest digit search
+  test::sprintf(buffer, "%r %r %r", -2.109808898695963E16, 4.940656E-318, 1.18575755E-316);
+  REQUIRE(!strcmp(buffer, "-21098088986959630 4.940656e-318 1.18575755e-316"));
+  test::sprintf(buffer, "%r %r %r", 2.989102097996E-312, 9.0608011534336E15, 4.708356024711512E18);
+  REQUIRE(!strcmp(buffer, "2.989102097996e-312 9060801153433600 4.708356024711512e+18"));
+  test::sprintf(buffer, "%r %r %r", 9.409340012568248E18, 2.2250738585072014E-308, 2.98023223876953125E-8);
+  REQUIRE(!strcmp(buffer, "9.409340012568248e+18 2.2250738585072014e-308 2.9802322387695312e-08"));
+
+  // the shortness check finds longer round-trip digits
+  REQUIRE(shorter_round_trips("0.10000000000000001", 0.1));
+  REQUIRE(shorter_round_trips("1.2345678000000001", 1.2345678));
+  REQUIRE(!shorter_round_trips("1.2345678", 1.2345678));
+
+  // brute force round-trip and shortness over random bit patterns
+  bool fail = false;
+  unsigned long long x = 88172645463325252ULL;
+  for (int i = 0; i < 100000; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    if (((x >> 52) & 0x7FFU) == 0x7FFU) {
+      continue;   // nan and inf
+    }
+    double value;
+    memcpy(&value, &x, sizeof(value));
+    test::sprintf(buffer, "%r", value);
+    fail = fail || (strtod(buffer, nullptr) != value) || shorter_round_trips(buffer, value);
+  }
+  REQUIRE(!fail);
+}
+#endif
+
+
 TEST_CASE("types", "[]" ) {
   char buffer[100];
 
@@ -1394,6 +2024,38 @@ TEST_CASE("pointer", "[]" ) {
 }
 
 
+TEST_CASE("literal text", "[]" ) {
+  char buffer[100];
+  char format[64];
+
+  test::sprintf(buffer, "This is a rather long literal text without any specifier");
+  REQUIRE(!strcmp(buffer, "This is a rather long literal text without any specifier"));
+
+  test::sprintf(buffer, "%%begin %d in the middle of a long text %d%%", 1, 2);
+  REQUIRE(!strcmp(buffer, "%begin 1 in the middle of a long text 2%"));
+
+  // specifier and terminator at every offset relative to the word alignment
+  bool fail = false;
+  for (size_t offset = 0U; offset < 16U; ++offset) {
+    for (size_t pos = 0U; pos < 24U; ++pos) {
+      char expected[64];
+      memset(format, 0, sizeof(format));
+      memset(format + offset, 'a', pos);
+      memcpy(format + offset + pos, "%c!", 3U);
+      memset(expected, 'a', pos);
+      memcpy(expected + pos, "Z!", 3U);
+      test::sprintf(buffer, format + offset, 'Z');
+      fail = fail || !!strcmp(buffer, expected);
+      format[offset + pos] = 0;
+      expected[pos] = 0;
+      test::sprintf(buffer, format + offset);
+      fail = fail || !!strcmp(buffer, expected);
+    }
+  }
+  REQUIRE(!fail);
+}
+
+
 TEST_CASE("unknown flag", "[]" ) {
   char buffer[100];
 
@@ -1448,6 +2110,268 @@ TEST_CASE("buffer length", "[]" ) {
 
   test::snprintf(buffer, 2, "%s", "Hello");
   REQUIRE(!strcmp(buffer, "H"));
+
+  // numbers clipped by the end of the buffer
+  ret = test::snprintf(buffer, 4, "%d", -12345);
+  REQUIRE(!strcmp(buffer, "-12"));
+  REQUIRE(ret == 6);
+  ret = test::snprintf(buffer, 8, "ab%#8x", 0xBEEFU);
+  REQUIRE(!strcmp(buffer, "ab  0xb"));
+  REQUIRE(ret == 10);
+}
+
+
+TEST_CASE("snprintf_trunc", "[]" ) {
+  char buffer[100];
+  bool truncated;
+
+  REQUIRE(test::snprintf_trunc(buffer, 10U, &truncated, "%s %d", "Test", 42) == 7);
+  REQUIRE(!strcmp(buffer, "Test 42"));
+  REQUIRE(!truncated);
+
+  REQUIRE(test::snprintf_trunc(buffer, 8U, &truncated, "%s %d", "Test", 42) == 7);
+  REQUIRE(!strcmp(buffer, "Test 42"));
+  REQUIRE(!truncated);
+
+  REQUIRE(test::snprintf_trunc(buffer, 7U, &truncated, "%s %d", "Test", 42) == 6);
+  REQUIRE(!strcmp(buffer, "Test 4"));
+  REQUIRE(truncated);
+
+  REQUIRE(test::snprintf_trunc(buffer, 5U, &truncated, "%-10s|%d|%f", "Test", 1, 2.0) == 4);
+  REQUIRE(!strcmp(buffer, "Test"));
+  REQUIRE(truncated);
+
+  buffer[0] = (char)0xA5;
+  REQUIRE(test::snprintf_trunc(buffer, 0U, &truncated, "%s", "Test") == 0);
+  REQUIRE(buffer[0] == (char)0xA5);
+  REQUIRE(truncated);
+
+  // no output, nothing is truncated
+  REQUIRE(test::snprintf_trunc(buffer, 0U, &truncated, "%s", "") == 0);
+  REQUIRE(!truncated);
+  REQUIRE(test::snprintf_trunc(buffer, 0U, &truncated, "") == 0);
+  REQUIRE(!truncated);
+  REQUIRE(test::snprintf_trunc(buffer, 1U, &truncated, "%s", "") == 0);
+  REQUIRE(!truncated);
+
+  // only the first output character is converted
+  REQUIRE(test::snprintf_trunc(nullptr, 0U, &truncated, "%s%d%s", "", 1, "Test") == 0);
+  REQUIRE(truncated);
+  REQUIRE(test::snprintf_trunc(nullptr, 0U, &truncated, "%s", "") == 0);
+  REQUIRE(!truncated);
+
+  // no buffer, nothing is written
+  REQUIRE(test::snprintf_trunc(nullptr, 8U, &truncated, "%s", "hello world") == 0);
+  REQUIRE(truncated);
+  REQUIRE(test::snprintf_trunc(nullptr, 8U, &truncated, "%s", "") == 0);
+  REQUIRE(!truncated);
+
+  REQUIRE(test::snprintf_trunc(buffer, 1U, nullptr, "%s", "Test") == 0);
+  REQUIRE(buffer[0] == '\0');
+}
+
+
+TEST_CASE("decimal boundaries", "[]" ) {
+  char buffer[100];
+  std::vector<unsigned long long> values = { 0U, 4294967295ULL, 4294967296ULL, 9223372036854775807ULL, 18446744073709551614ULL, 18446744073709551615ULL };
+  for (unsigned long long p = 10U; p <= 10000000000000000000ULL; p *= 10U) {
+    values.push_back(p - 1U);
+    values.push_back(p);
+    if (p > 1844674407370955161ULL) {
+      break;
+    }
+  }
+
+  for (const unsigned long long v : values) {
+    const std::string d = std::to_string(v);
+    const std::string spaces(25U - d.size(), ' ');
+    const std::string zeros(25U - d.size(), '0');
+
+    test::sprintf(buffer, "%llu", v);
+    REQUIRE(buffer == d);
+    test::sprintf(buffer, "%25llu", v);
+    REQUIRE(buffer == spaces + d);
+    test::sprintf(buffer, "%-25llu|", v);
+    REQUIRE(buffer == d + spaces + "|");
+    test::sprintf(buffer, "%025llu", v);
+    REQUIRE(buffer == zeros + d);
+    test::sprintf(buffer, "%.25llu", v);
+    REQUIRE(buffer == zeros + d);
+    test::sprintf(buffer, "%30.25llu", v);
+    REQUIRE(buffer == "     " + zeros + d);
+
+    if (v <= 9223372036854775807ULL) {
+      test::sprintf(buffer, "%+lld", (long long)v);
+      REQUIRE(buffer == "+" + d);
+      test::sprintf(buffer, "%lld", -(long long)v);
+      REQUIRE(buffer == (v ? "-" : "") + d);
+      test::sprintf(buffer, "%025lld", -(long long)v);
+      REQUIRE(buffer == (v ? "-" + zeros.substr(1U) : zeros) + d);
+    }
+
+    if (v <= 4294967295ULL) {
+      const std::string spaces32(12U - d.size(), ' ');
+      const std::string zeros32(12U - d.size(), '0');
+      test::sprintf(buffer, "%u", (unsigned int)v);
+      REQUIRE(buffer == d);
+      test::sprintf(buffer, "%12u", (unsigned int)v);
+      REQUIRE(buffer == spaces32 + d);
+      test::sprintf(buffer, "%-12u|", (unsigned int)v);
+      REQUIRE(buffer == d + spaces32 + "|");
+      test::sprintf(buffer, "%012lu", (unsigned long)v);
+      REQUIRE(buffer == zeros32 + d);
+      test::sprintf(buffer, "%.12lu", (unsigned long)v);
+      REQUIRE(buffer == zeros32 + d);
+    }
+  }
+
+  // the limits of the signed types
+  test::sprintf(buffer, "%d|%d", 2147483647, -2147483647 - 1);
+  REQUIRE(!strcmp(buffer, "2147483647|-2147483648"));
+  test::sprintf(buffer, "%lld|%lld", 9223372036854775807LL, -9223372036854775807LL - 1);
+  REQUIRE(!strcmp(buffer, "9223372036854775807|-9223372036854775808"));
+  test::sprintf(buffer, "%+25lld|%-+25lld|", -9223372036854775807LL - 1, 9223372036854775807LL);
+  REQUIRE(!strcmp(buffer, "     -9223372036854775808|+9223372036854775807     |"));
+}
+
+
+TEST_CASE("decimal digits", "[]" ) {
+  char buffer[100];
+
+  test::sprintf(buffer, "%llu", 10000000000000000000ULL);
+  REQUIRE(!strcmp(buffer, "10000000000000000000"));
+  test::sprintf(buffer, "%llu", 12345678909876543210ULL);
+  REQUIRE(!strcmp(buffer, "12345678909876543210"));
+  test::sprintf(buffer, "%lu", 99999999UL);
+  REQUIRE(!strcmp(buffer, "99999999"));
+  test::sprintf(buffer, "%lu", 100000000UL);
+  REQUIRE(!strcmp(buffer, "100000000"));
+  test::sprintf(buffer, "%.17llu", 1000000001ULL);
+  REQUIRE(!strcmp(buffer, "00000001000000001"));
+}
+
+
+#if defined(__SIZEOF_INT128__)
+TEST_CASE("128 bit integers", "[]" ) {
+  char buffer[200];
+  const test::uint128_type value = ((test::uint128_type)0x0123456789ABCDEFULL << 64U) | 0xFEDCBA9876543210ULL;
+  const test::uint128_type max   = ~(test::uint128_type)0U;
+
+  test::sprintf(buffer, "%w128u", value);
+  REQUIRE(!strcmp(buffer, "1512366075204170947332355369683137040"));
+  test::sprintf(buffer, "%w128u", max);
+  REQUIRE(!strcmp(buffer, "340282366920938463463374607431768211455"));
+  test::sprintf(buffer, "%w128d", -(test::int128_type)(max >> 1U));
+  REQUIRE(!strcmp(buffer, "-170141183460469231731687303715884105727"));
+  test::sprintf(buffer, "%+w128d|%-6w128i|", (test::int128_type)42, (test::int128_type)-7);
+  REQUIRE(!strcmp(buffer, "+42|-7    |"));
+  test::sprintf(buffer, "%#w128x", value);
+  REQUIRE(!strcmp(buffer, "0x123456789abcdeffedcba9876543210"));
+  test::sprintf(buffer, "%w128X", (test::uint128_type)0xABCU << 64U);
+  REQUIRE(!strcmp(buffer, "ABC0000000000000000"));
+  test::sprintf(buffer, "%w128o", max);
+  REQUIRE(!strcmp(buffer, "3777777777777777777777777777777777777777777"));
+  test::sprintf(buffer, "%w128b", ((test::uint128_type)1U << 100U) | 5U);
+  REQUIRE(!strcmp(buffer, "10000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000101"));
+  test::sprintf(buffer, "%.25w128u", (test::uint128_type)123U);
+  REQUIRE(!strcmp(buffer, "0000000000000000000000123"));
+
+  // other exact width types
+  test::sprintf(buffer, "%w8d %w16u %w32x %w64d", 0x181, 0x10010, 0xABCU, (int64_t)-5000000000LL);
+  REQUIRE(!strcmp(buffer, "-127 16 abc -5000000000"));
+
+  // through a character sink
+  printf_idx = 0U;
+  memset(printf_buffer, 0xCC, 100U);
+  test::printf("%w128u|", max);
+  REQUIRE(!strncmp(printf_buffer, "340282366920938463463374607431768211455|", 40U));
+
+  // binary log encoding
+  static const char* const formats[] = { "%w128x %d" };
+  const char* data = buffer;
+  REQUIRE(test::binprintf(buffer, sizeof(buffer), formats, 0U, value, 3) == 1 + 1 + 10 + 9 + 1);
+  printf_idx = 0U;
+  REQUIRE(test::binprintf_decode(formats, 1U, &data, 22U, &_out_chunk, nullptr) == 33);
+  REQUIRE(!strncmp(printf_buffer, "123456789abcdeffedcba9876543210 3", 33U));
+}
+#endif
+
+
+TEST_CASE("power of 2 bases", "[]" ) {
+  char buffer[100];
+
+  test::sprintf(buffer, "%llx", 0x0123456789ABCDEFULL);
+  REQUIRE(!strcmp(buffer, "123456789abcdef"));
+  test::sprintf(buffer, "%llX", 0xFEDCBA9876543210ULL);
+  REQUIRE(!strcmp(buffer, "FEDCBA9876543210"));
+  test::sprintf(buffer, "%#.20llx", 0xA0B0C0D0E0F00000ULL);
+  REQUIRE(!strcmp(buffer, "0x0000a0b0c0d0e0f00000"));
+  test::sprintf(buffer, "%llo", 0xFFFFFFFFFFFFFFFFULL);
+  REQUIRE(!strcmp(buffer, "1777777777777777777777"));
+  test::sprintf(buffer, "%#b", 0x80000001U);
+  REQUIRE(!strcmp(buffer, "0b10000000000000000000000000000001"));
+
+  // the same through a character sink
+  printf_idx = 0U;
+  memset(printf_buffer, 0xCC, 100U);
+  test::printf("%016llX|%x", 0x00000000DEADBEEFULL, 0x9AU);
+  REQUIRE(!strncmp(printf_buffer, "00000000DEADBEEF|9a", 19U));
+}
+
+
+TEST_CASE("format_int_array", "[]" ) {
+  char buffer[100];
+  const int64_t values[] = { 0, -1, 42, INT64_MIN + 1, INT64_MAX };
+  const uint64_t uvalues[] = { 0U, 255U, UINT64_MAX };
+  const uint32_t u32values[] = { 7U, 4294967295U };
+
+  REQUIRE(test::format_int_array(buffer, sizeof(buffer), values, 5U, ",", 0U) == 48);
+  REQUIRE(!strcmp(buffer, "0,-1,42,-9223372036854775807,9223372036854775807"));
+  REQUIRE(test::format_int_array(buffer, sizeof(buffer), values, 3U, "; ", PRINTF_FLAGS_PLUS | PRINTF_FLAGS_WIDTH(4)) == 16);
+  REQUIRE(!strcmp(buffer, "  +0;   -1;  +42"));
+  REQUIRE(test::format_int_array(buffer, sizeof(buffer), values, 3U, nullptr, PRINTF_FLAGS_ZEROPAD | PRINTF_FLAGS_WIDTH(3)) == 9);
+  REQUIRE(!strcmp(buffer, "000-01042"));
+  REQUIRE(test::format_uint_array(buffer, sizeof(buffer), uvalues, 3U, " ", PRINTF_FLAGS_LEFT | PRINTF_FLAGS_PLUS | PRINTF_FLAGS_WIDTH(4)) == 30);
+  REQUIRE(!strcmp(buffer, "0    255  18446744073709551615"));
+  REQUIRE(test::format_uint32_array(buffer, sizeof(buffer), u32values, 2U, "\n", 0U) == 12);
+  REQUIRE(!strcmp(buffer, "7\n4294967295"));
+  REQUIRE(test::format_hex_array(buffer, sizeof(buffer), uvalues, 3U, " ", PRINTF_FLAGS_HASH | PRINTF_FLAGS_UPPERCASE) == 25);
+  REQUIRE(!strcmp(buffer, "0 0XFF 0XFFFFFFFFFFFFFFFF"));
+
+  // truncated and length only
+  REQUIRE(test::format_int_array(buffer, 6U, values, 5U, ",", 0U) == 48);
+  REQUIRE(!strcmp(buffer, "0,-1,"));
+  REQUIRE(test::format_int_array(nullptr, 0U, values, 5U, ",", 0U) == 48);
+  REQUIRE(test::format_int_array(buffer, sizeof(buffer), values, 0U, ",", 0U) == 0);
+  REQUIRE(!strcmp(buffer, ""));
+}
+
+
+TEST_CASE("length only", "[]" ) {
+  // the measured length must match the formatted length
+  char buffer[100];
+  static const char* const formats[] = {
+    "%d", "%+08d", "% -7i", "%#o", "%#12x", "%#010X", "%.0d", "%5.3u", "%#b", "%llb", "%-20llx"
+  };
+  static const long long values[] = { 0, 1, -1, 9, 10, 99, 100, 255, -32768, 2147483647LL, -9223372036854775807LL };
+  for (size_t i = 0U; i < sizeof(formats) / sizeof(formats[0]); i++) {
+    for (size_t j = 0U; j < sizeof(values) / sizeof(values[0]); j++) {
+      if (formats[i][strlen(formats[i]) - 2U] == 'l') {
+        REQUIRE(test::snprintf(nullptr, 0, formats[i], values[j]) == test::snprintf(buffer, sizeof(buffer), formats[i], values[j]));
+      }
+      else {
+        REQUIRE(test::snprintf(nullptr, 0, formats[i], (int)values[j]) == test::snprintf(buffer, sizeof(buffer), formats[i], (int)values[j]));
+      }
+    }
+  }
+
+  static const char* const float_formats[] = { "%f", "%.0f", "%-10.3f", "%+012.5f", "%.12f", "%e", "%g", "%#.3G", "%20.4e" };
+  static const double float_values[] = { 0.0, -0.5, 0.99999, 9.5, 99.96, -123456.789, 1e-7, 4.2e12, 1.0 / 0.0 };
+  for (size_t i = 0U; i < sizeof(float_formats) / sizeof(float_formats[0]); i++) {
+    for (size_t j = 0U; j < sizeof(float_values) / sizeof(float_values[0]); j++) {
+      REQUIRE(test::snprintf(nullptr, 0, float_formats[i], float_values[j]) == test::snprintf(buffer, sizeof(buffer), float_formats[i], float_values[j]));
+    }
+  }
 }
 
 